@@ -1,30 +1,227 @@
+#define _POSIX_C_SOURCE 200809L // strdup, strndup, getline, strtok_r, fdopen
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
 
-#define MAX_EVENTS 100
-#define MAX_TITLE_LEN 100
-#define MAX_LOCATION_LEN 100
-#define MAX_DESCRIPTION_LEN 200
-#define FILENAME "events.txt"
+#define ARENA_BLOCK_SIZE 65536
+#define FILENAME "events.txt" // Legacy single-file storage, migrated on first run
+#define MANIFEST_FILENAME "events.manifest"
+#define ID_INDEX_FILENAME "events.ids" // Month of every event id, see idMonths
+#define PARTITION_FILE_FORMAT "events-%s.txt"
+#define ATTENDEE_FILE_FORMAT "events-%s.rsvp" // Attendee bitmaps for a partition
+#define USER_EVENTS_FILENAME "attendees.rsvp" // Event bitmaps for every user
+#define PARTITION_KEY_LEN 8 // "YYYY-MM" plus terminator
 #define ADMIN_PASSWORD "admin123"
+#define SUMMARY_MIN_YEAR 2000
+#define SUMMARY_YEARS 101              // validateDate accepts 2000-2100
+#define SUMMARY_MAX_THREADS 8
+#define SUMMARY_EVENTS_PER_THREAD 4096 // Smaller inputs are not worth a thread
+#define SUMMARY_SKETCH_SIZE 64         // Space-Saving counters per thread
+#define SUMMARY_TOP_K 10
+#define FEED_SOCKET "eventease.sock"
+#define FEED_MAX_FOLLOWERS 16
+#define FEED_STALL_SECONDS 10 // Followers whose queue doesn't drain are dropped
+#define FEED_SNAPSHOT_TIMEOUT 10 // Replicas reconnect if a snapshot stalls this long
+#define SUGGEST_TOP_K 8
+#define CACHE_BUDGET_BYTES (4 * 1024 * 1024)
+#define CACHE_BUCKETS 1024
+#define ROARING_ARRAY_MAX 4096 // Denser containers switch to a 65536-bit bitmap
+#define ATTENDEE_LIST_MAX 20
 
+// Roaring-style compressed bitmap of user ids. Ids are split into
+// containers by their high 16 bits; each container stores the low 16 bits
+// as a sorted array while small and as a plain bitmap once dense.
+typedef struct
+{
+    unsigned short key;
+    int cardinality;
+    int arrayCapacity;
+    unsigned short *array;   // Used while cardinality <= ROARING_ARRAY_MAX
+    unsigned long long *bits; // 1024 words, used instead of array when dense
+} RoaringContainer;
+
+typedef struct
+{
+    RoaringContainer *containers; // Sorted by key
+    int count;
+    int capacity;
+} RoaringBitmap;
+
+// The reverse of Event.attendees: which events one user registered for.
+// Kept for all users at once so the lookup never loads partitions to scan.
+typedef struct
+{
+    int userId; // -1 marks an empty slot
+    RoaringBitmap events;
+} UserEvents;
+
+// Text fields point into the string arena below and may be any length
 typedef struct
 {
     int id;
-    char title[MAX_TITLE_LEN];
     char date[11];
     char time[6];
-    char description[MAX_DESCRIPTION_LEN];
-    char location[MAX_LOCATION_LEN];
+    char *title;
+    char *description;
+    char *location;
+    int capacity; // 0 means unlimited
+    RoaringBitmap attendees;
 } Event;
 
-Event events[MAX_EVENTS];
+// Strings are bump-allocated from a chain of blocks. Edits and deletes only
+// mark the old text dead; compactArena() copies live text into fresh blocks
+// once more than half of the arena is dead.
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *next;
+    size_t used;
+    size_t size;
+    char data[];
+} ArenaBlock;
+
+// One partition per calendar month. The manifest keeps the summary fields
+// so a partition's file is only read once something actually needs it:
+// the date range lets a date search skip the file, maxId seeds nextEventId.
+typedef struct
+{
+    char key[PARTITION_KEY_LEN];
+    int count;
+    char minDate[11];
+    char maxDate[11];
+    int maxId;
+    int loaded;
+    int dirty;
+    int failed; // File only partly read, so it must never be rewritten
+} Partition;
+
+typedef struct
+{
+    const char *location; // Points into events[], not owned
+    int count;
+    int error; // Space-Saving overestimate, 0 for exact counts
+} LocationCount;
+
+// Histograms for one slice of events[]; slices are merged after the pass
+typedef struct
+{
+    int start;
+    int end;
+    int trackLocations;
+    int trackTopLocations;
+    int yearMonthCount[SUMMARY_YEARS * 12];
+    int dayCount[32];
+    int weekdayCount[7];
+    int hourCount[24];
+    LocationCount *locations; // Open addressing table keyed case-insensitively
+    int locationCount;
+    int locationCapacity;
+    LocationCount sketch[SUMMARY_SKETCH_SIZE];
+    int sketchCount;
+} SummaryPartial;
+
+// A read replica connected to this process's change feed
+typedef struct
+{
+    int fd;
+    long ackedSequence;
+    time_t connectedAt;
+    time_t lastAck;
+    int failed; // Closed by the feed thread on its next pass
+    char *pending; // Output the socket hasn't accepted yet, sent by the feed thread
+    size_t pendingLength;
+    size_t pendingCapacity;
+    size_t pendingSent;
+    time_t lastProgress;
+} Follower;
+
+// Path-compressed radix trie over lowercased titles or locations. Each node
+// caches the SUGGEST_TOP_K most frequent keys below it, so a suggestion is a
+// walk down the prefix followed by a copy of that node's list.
+typedef struct TrieNode
+{
+    char *label; // Edge label from the parent
+    struct TrieNode **children; // Sorted by first label byte
+    int childCount;
+    int childCapacity;
+    int count;  // Events whose key ends at this node
+    char *text; // Spelling shown in suggestions
+    struct TrieNode *top[SUGGEST_TOP_K];
+    int topCount;
+} TrieNode;
+
+// Cached result of a search ('D'ate, 'T'itle, 'L'ocation: matching event ids)
+// or of a summary ('S': the merged histograms). Entries sit in a hash chain
+// for lookup and in a list ordered from most to least recently used.
+typedef struct CacheEntry
+{
+    char mode;
+    char *term; // Date as typed, lowercased text, or the summary choice
+    int *ids;
+    int idCount;
+    SummaryPartial *summary;
+    size_t bytes;
+    struct CacheEntry *chain;
+    struct CacheEntry *newer;
+    struct CacheEntry *older;
+} CacheEntry;
+
+ArenaBlock *arena = NULL;
+size_t arenaLiveBytes = 0;
+size_t arenaDeadBytes = 0;
+CacheEntry *cacheBuckets[CACHE_BUCKETS];
+CacheEntry *cacheNewest = NULL;
+CacheEntry *cacheOldest = NULL;
+size_t cacheBytes = 0;
+int cacheEntries = 0;
+long cacheHits = 0;
+long cacheMisses = 0;
+long cacheEvictions = 0;
+long cacheInvalidations = 0;
+UserEvents *userEvents = NULL; // Open addressing by user id
+int userEventCount = 0;
+int userEventCapacity = 0;
+int userEventsDirty = 0;
+int userEventsPartial = 0; // Same as idIndexPartial, for the per-user index
+int *idSlots = NULL; // Open addressing from event id to index + 1, 0 = empty
+int idSlotCapacity = 0;
+TrieNode titleTrie;
+TrieNode locationTrie;
+Event *events = NULL; // Events from loaded partitions only
 int eventCount = 0;
+int eventCapacity = 0;
+Partition *partitions = NULL;
+int partitionCount = 0;
+int partitionCapacity = 0;
+unsigned short *idMonths = NULL; // By event id: year * 12 + month - 1, 0 = no event
+int idMonthCapacity = 0;
+int idIndexPartial = 0; // Built while a month was unreadable; never saved
+int nextEventId = 1;
 int isAdmin = 0;
 
+// Change feed state. events[] is only modified while holding dataLock so the
+// feed thread (leader) or apply thread (replica) never sees a partial update.
+pthread_mutex_t dataLock = PTHREAD_MUTEX_INITIALIZER;
+const char *feedSocket = FEED_SOCKET;
+int feedListener = -1;
+long feedSequence = 0;
+Follower followers[FEED_MAX_FOLLOWERS];
+int followerCount = 0;
+int isReplica = 0;
+int replicaConnected = 0;
+long replicaSequence = 0;
+time_t replicaLastUpdate = 0;
+
 void login();
 void displayMenu();
 void addEvent();
@@ -35,18 +232,133 @@ void saveEvents();
 void loadEvents();
 void searchEvents();
 void eventSummary();
+SummaryPartial *computeSummary(int choice);
+void *summarizeRange(void *arg);
+void mergeSummary(SummaryPartial *into, const SummaryPartial *from);
+void countLocation(SummaryPartial *partial, const char *location, int count);
+void sketchLocation(SummaryPartial *partial, const char *location, int count, int error);
+int compareLocationCounts(const void *a, const void *b);
+unsigned int hashText(const char *text);
+int dayOfWeek(int year, int month, int day);
 int validateDate(const char *date);
 int validateTime(const char *time);
-// void sortEvents();
-// int compareDates(const char *date1, const char *date2);
+void sortEvents();
+unsigned int dateTimeKey(const Event *event);
+void radixSortByDateTime(int *order, int *scratch, int count);
+void mergeSortByText(int *order, int *scratch, int count, int key);
+const char *sortText(int index, int key);
 void toLowerCase(char *str);
 int isLeapYear(int year);
 int isValidDate(int day, int month, int year);
 void clearInputBuffer();
+char *readLine();
+int containsIgnoreCase(const char *text, const char *term);
+char *arenaStrdup(const char *text);
+void arenaRelease(const char *text);
+void releaseEventStrings(const Event *event);
+void maybeCompactArena();
+void compactArena();
+void indexEvent(const Event *event, int delta);
+void trieUpdate(TrieNode *root, const char *text, int delta);
+int trieSuggest(TrieNode *root, const char *prefix, TrieNode **results);
+TrieNode *trieNewNode(const char *label, size_t length);
+int trieFindChild(const TrieNode *node, char first);
+void trieInsertChild(TrieNode *node, TrieNode *child);
+void trieRemoveChild(TrieNode *node, const TrieNode *child);
+void trieMergeChild(TrieNode *node);
+void trieRecomputeTop(TrieNode *node);
+int trieOfferTop(TrieNode *node, TrieNode *candidate);
+void partitionKey(const char *date, char *key);
+int findPartition(const char *key);
+int getPartition(const char *key);
+int loadPartition(int index);
+int loadAllPartitions();
+void loadPartitionsForId(int id);
+void markPartitionDirty(const char *date);
+void setIdMonth(int id, const char *date);
+int loadIdIndex();
+void saveIdIndex();
+int parseEventLine(char *line, Event *event);
+char *nextField(char **rest);
+void appendEvent(const Event *event);
+void removeEventAt(int index);
+int findEventIndex(int id);
+int lookupEventIndex(int id);
+void startChangeFeed();
+void *feedThread(void *arg);
+void sendSnapshot(Follower *follower);
+void publishChange(const char *operation, const Event *event, int id);
+void queueOutput(Follower *follower, const char *data, size_t length);
+void flushOutput(Follower *follower);
+void startReplica();
+void *replicaThread(void *arg);
+int connectToFeed();
+int applyChange(char *line, FILE *feed);
+int applySnapshot(FILE *feed, int count, long sequence);
+int sendAll(int fd, const char *buffer, size_t length);
+char *formatEventLine(const Event *event);
+void replicationStatus();
+int printMatches(char mode, const char *term);
+CacheEntry *cacheLookup(char mode, const char *term);
+void cacheStore(char mode, const char *term, int *ids, int idCount, SummaryPartial *summary);
+void cacheRemove(CacheEntry *entry);
+void invalidateCache(const Event *oldEvent, const Event *newEvent);
+void invalidateSummaries();
+int eventMatches(char mode, const char *term, const Event *event);
+void cacheStatus();
+void rebuildIdIndex(int capacity);
+void manageAttendees();
+int promptNumber(const char *prompt, int *value);
+void saveAttendees(const char *key);
+void loadAttendees(const char *key);
+RoaringBitmap *eventsForUser(int userId, int create);
+void forgetAttendees(const Event *event);
+void saveUserEvents();
+void loadUserEvents();
+int roaringFind(const RoaringBitmap *bitmap, unsigned short key);
+int roaringArrayPosition(const RoaringContainer *container, unsigned short value);
+int roaringAdd(RoaringBitmap *bitmap, unsigned int value);
+int roaringRemove(RoaringBitmap *bitmap, unsigned int value);
+int roaringContains(const RoaringBitmap *bitmap, unsigned int value);
+int roaringCardinality(const RoaringBitmap *bitmap);
+void roaringAnd(const RoaringBitmap *a, const RoaringBitmap *b, RoaringBitmap *result);
+int roaringToArray(const RoaringBitmap *bitmap, unsigned int *values, int max);
+void roaringToBits(RoaringContainer *container);
+void roaringToArrayContainer(RoaringContainer *container);
+void roaringAppend(RoaringBitmap *bitmap, const RoaringContainer *container);
+void roaringFree(RoaringBitmap *bitmap);
+int roaringWrite(const RoaringBitmap *bitmap, FILE *file);
+int roaringRead(RoaringBitmap *bitmap, FILE *file);
 
-int main()
+int main(int argc, char *argv[])
 {
-    loadEvents();
+    int publishFeed = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--feed") == 0 || strcmp(argv[i], "--follow") == 0)
+        {
+            publishFeed = strcmp(argv[i], "--feed") == 0;
+            isReplica = !publishFeed;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                feedSocket = argv[++i];
+        }
+        else
+        {
+            printf("Usage: %s [--feed [socket] | --follow [socket]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (isReplica)
+    {
+        startReplica();
+    }
+    else
+    {
+        loadEvents();
+        if (publishFeed)
+            startChangeFeed();
+    }
     login();
 
     int choice;
@@ -88,20 +400,26 @@ int main()
         case 5:
             searchEvents();
             break;
-        // case 6:
-        //     if (isAdmin)
-        //         sortEvents();
-        //     else
-        //         printf("Access denied! Admin only feature.\n");
-        //     break;
         case 6:
-            eventSummary();
+            sortEvents();
             break;
         case 7:
-            login();
+            eventSummary();
             break;
         case 8:
+            manageAttendees();
+            break;
+        case 9:
+            login();
+            break;
+        case 10:
+            replicationStatus();
+            cacheStatus();
+            break;
+        case 11:
             saveEvents();
+            if (feedListener != -1)
+                unlink(feedSocket);
             printf("Exiting program. Goodbye!\n");
             break;
         default:
@@ -109,7 +427,7 @@ int main()
         }
         printf("\nPress Enter to continue...");
         clearInputBuffer();
-    } while (choice != 9);
+    } while (choice != 11);
 
     return 0;
 }
@@ -125,6 +443,14 @@ void login()
 {
     char password[50];
     printf("=== EventEase Login ===\n");
+    if (isReplica)
+    {
+        // Replicas only mirror the leader, so nothing may be edited here
+        isAdmin = 0;
+        printf("Read replica: guest access only.\n");
+        return;
+    }
+
     printf("Enter admin password (or press Enter for guest access): ");
     fgets(password, sizeof(password), stdin);
     password[strcspn(password, "\n")] = 0; // Remove newline
@@ -149,57 +475,95 @@ void displayMenu()
     printf("3. Edit an Event (Admin Only)\n");
     printf("4. Delete an Event (Admin Only)\n");
     printf("5. Search Events\n");
-    printf("6. Event Summary\n");
-    printf("7. Switch User\n");
-    printf("8. Exit\n");
+    printf("6. Sort Events\n");
+    printf("7. Event Summary\n");
+    printf("8. Attendees (RSVP)\n");
+    printf("9. Switch User\n");
+    printf("10. System Status\n");
+    printf("11. Exit\n");
 }
 
 void addEvent()
 {
-    if (eventCount >= MAX_EVENTS)
-    {
-        printf("Event storage full! Cannot add more events.\n");
-        return;
-    }
-
     Event newEvent;
-    newEvent.id = eventCount > 0 ? events[eventCount - 1].id + 1 : 1;
+    char *input;
+    memset(&newEvent, 0, sizeof(Event));
+    newEvent.id = nextEventId;
 
     printf("Enter event title: ");
-    fgets(newEvent.title, sizeof(newEvent.title), stdin);
-    newEvent.title[strcspn(newEvent.title, "\n")] = 0;
+    input = readLine();
+    newEvent.title = arenaStrdup(input);
+    free(input);
 
     printf("Enter event description: ");
-    fgets(newEvent.description, sizeof(newEvent.description), stdin);
-    newEvent.description[strcspn(newEvent.description, "\n")] = 0;
+    input = readLine();
+    newEvent.description = arenaStrdup(input);
+    free(input);
 
     printf("Enter event location: ");
-    fgets(newEvent.location, sizeof(newEvent.location), stdin);
-    newEvent.location[strcspn(newEvent.location, "\n")] = 0;
+    input = readLine();
+    newEvent.location = arenaStrdup(input);
+    free(input);
 
     do
     {
         printf("Enter event date (YYYY-MM-DD): ");
-        fgets(newEvent.date, sizeof(newEvent.date), stdin);
-        newEvent.date[strcspn(newEvent.date, "\n")] = 0;
-    } while (!validateDate(newEvent.date));
+        input = readLine();
+        if (validateDate(input))
+            break;
+        free(input);
+    } while (1);
+    strcpy(newEvent.date, input);
+    free(input);
 
     do
     {
         printf("Enter event time (HH:MM): ");
-        fgets(newEvent.time, sizeof(newEvent.time), stdin);
-        newEvent.time[strcspn(newEvent.time, "\n")] = 0;
-    } while (!validateTime(newEvent.time));
+        input = readLine();
+        if (validateTime(input))
+            break;
+        free(input);
+    } while (1);
+    strcpy(newEvent.time, input);
+    free(input);
+
+    do
+    {
+        printf("Enter event capacity (0 for unlimited): ");
+        input = readLine();
+        newEvent.capacity = atoi(input);
+        if (input[0] != 0 && strspn(input, "0123456789") == strlen(input))
+            break;
+        free(input);
+    } while (1);
+    free(input);
+
+    // The month's partition must be in memory before it is rewritten
+    pthread_mutex_lock(&dataLock);
+    if (!loadPartition(getPartition(newEvent.date)))
+    {
+        pthread_mutex_unlock(&dataLock);
+        releaseEventStrings(&newEvent);
+        printf("Event not added: events for %.7s could not be read.\n", newEvent.date);
+        return;
+    }
+    appendEvent(&newEvent);
+    markPartitionDirty(newEvent.date);
+    invalidateCache(NULL, &newEvent);
+    publishChange("ADD", &newEvent, newEvent.id);
+    pthread_mutex_unlock(&dataLock);
 
-    events[eventCount++] = newEvent;
     saveEvents();
     printf("Event added successfully with ID: %d\n", newEvent.id);
 }
 
 void viewEvents()
 {
+    pthread_mutex_lock(&dataLock);
+    loadAllPartitions();
     if (eventCount == 0)
     {
+        pthread_mutex_unlock(&dataLock);
         printf("No events to display.\n");
         return;
     }
@@ -217,6 +581,7 @@ void viewEvents()
                events[i].location,
                events[i].description);
     }
+    pthread_mutex_unlock(&dataLock);
 
     // REMOVE THIS PART - it's causing the input buffer issue
     /*
@@ -239,7 +604,7 @@ void viewEvents()
 
 void editEvent()
 {
-    if (eventCount == 0)
+    if (partitionCount == 0)
     {
         printf("No events to edit.\n");
         return;
@@ -255,15 +620,7 @@ void editEvent()
     }
     clearInputBuffer(); // Consume newline
 
-    int found = -1;
-    for (int i = 0; i < eventCount; i++)
-    {
-        if (events[i].id == id)
-        {
-            found = i;
-            break;
-        }
-    }
+    int found = findEventIndex(id);
 
     if (found == -1)
     {
@@ -274,74 +631,143 @@ void editEvent()
     printf("Editing Event ID: %d\n", id);
     printf("Leave field blank to keep current value.\n");
 
-    char input[100];
+    // Collect the changes on a copy so the feed never sees a half-edited event
+    Event updated = events[found];
+    char *input;
 
     printf("Current title: %s\n", events[found].title);
     printf("Enter new title: ");
-    fgets(input, sizeof(input), stdin);
-    input[strcspn(input, "\n")] = 0;
+    input = readLine();
     if (strlen(input) > 0)
     {
-        strcpy(events[found].title, input);
+        updated.title = arenaStrdup(input);
     }
+    free(input);
 
     printf("Current date: %s\n", events[found].date);
     do
     {
         printf("Enter new date (YYYY-MM-DD): ");
-        fgets(input, sizeof(input), stdin);
-        input[strcspn(input, "\n")] = 0;
+        input = readLine();
         if (strlen(input) > 0)
         {
             if (validateDate(input))
             {
-                strcpy(events[found].date, input);
+                strcpy(updated.date, input);
+                free(input);
                 break;
             }
         }
         else
         {
+            free(input);
             break;
         }
+        free(input);
     } while (1);
 
     printf("Current time: %s\n", events[found].time);
     do
     {
         printf("Enter new time (HH:MM): ");
-        fgets(input, sizeof(input), stdin);
-        input[strcspn(input, "\n")] = 0;
+        input = readLine();
         if (strlen(input) > 0)
         {
             if (validateTime(input))
             {
-                strcpy(events[found].time, input);
+                strcpy(updated.time, input);
+                free(input);
                 break;
             }
         }
         else
         {
+            free(input);
             break;
         }
+        free(input);
     } while (1);
 
     printf("Current location: %s\n", events[found].location);
     printf("Enter new location: ");
-    fgets(input, sizeof(input), stdin);
-    input[strcspn(input, "\n")] = 0;
+    input = readLine();
     if (strlen(input) > 0)
     {
-        strcpy(events[found].location, input);
+        updated.location = arenaStrdup(input);
     }
+    free(input);
 
     printf("Current description: %s\n", events[found].description);
     printf("Enter new description: ");
-    fgets(input, sizeof(input), stdin);
-    input[strcspn(input, "\n")] = 0;
+    input = readLine();
     if (strlen(input) > 0)
     {
-        strcpy(events[found].description, input);
+        updated.description = arenaStrdup(input);
+    }
+    free(input);
+
+    int attendeeCount = roaringCardinality(&events[found].attendees);
+    printf("Current capacity: %d (0 = unlimited, %d registered)\n", events[found].capacity, attendeeCount);
+    do
+    {
+        printf("Enter new capacity: ");
+        input = readLine();
+        if (strlen(input) == 0)
+        {
+            free(input);
+            break;
+        }
+
+        int capacity = atoi(input);
+        if (strspn(input, "0123456789") == strlen(input) &&
+            (capacity == 0 || capacity >= attendeeCount))
+        {
+            updated.capacity = capacity;
+            free(input);
+            break;
+        }
+        printf("Capacity must be 0 or at least the number registered.\n");
+        free(input);
+    } while (1);
+
+    pthread_mutex_lock(&dataLock);
+    // Moving to another month rewrites that partition too, so it has to be
+    // loaded first; neither month may be rewritten unless fully read
+    int sourceLoaded = loadPartition(getPartition(events[found].date));
+    int targetLoaded = loadPartition(getPartition(updated.date));
+    if (!sourceLoaded || !targetLoaded)
+    {
+        printf("Event not updated: events for %.7s could not be read.\n",
+               sourceLoaded ? updated.date : events[found].date);
+        pthread_mutex_unlock(&dataLock);
+        if (updated.title != events[found].title)
+            arenaRelease(updated.title);
+        if (updated.location != events[found].location)
+            arenaRelease(updated.location);
+        if (updated.description != events[found].description)
+            arenaRelease(updated.description);
+        return;
     }
+    if (strncmp(updated.date, events[found].date, PARTITION_KEY_LEN - 1) != 0)
+        markPartitionDirty(events[found].date);
+
+    indexEvent(&events[found], -1);
+    indexEvent(&updated, 1);
+    invalidateCache(&events[found], &updated);
+
+    // Text that was replaced becomes dead space in the arena
+    if (updated.title != events[found].title)
+        arenaRelease(events[found].title);
+    if (updated.location != events[found].location)
+        arenaRelease(events[found].location);
+    if (updated.description != events[found].description)
+        arenaRelease(events[found].description);
+
+    events[found] = updated;
+    markPartitionDirty(updated.date);
+    publishChange("EDIT", &updated, updated.id);
+    maybeCompactArena();
+    pthread_mutex_unlock(&dataLock);
 
     saveEvents();
     printf("Event updated successfully.\n");
@@ -349,7 +775,7 @@ void editEvent()
 
 void deleteEvent()
 {
-    if (eventCount == 0)
+    if (partitionCount == 0)
     {
         printf("No events to delete.\n");
         return;
@@ -365,15 +791,7 @@ void deleteEvent()
     }
     clearInputBuffer(); // Consume newline
 
-    int found = -1;
-    for (int i = 0; i < eventCount; i++)
-    {
-        if (events[i].id == id)
-        {
-            found = i;
-            break;
-        }
-    }
+    int found = findEventIndex(id);
 
     if (found == -1)
     {
@@ -394,12 +812,20 @@ void deleteEvent()
 
     if (confirm == 'y' || confirm == 'Y')
     {
-        // Shift all events after the found index to the left
-        for (int i = found; i < eventCount - 1; i++)
+        pthread_mutex_lock(&dataLock);
+        if (!loadPartition(getPartition(events[found].date)))
         {
-            events[i] = events[i + 1];
+            printf("Event not deleted: events for %.7s could not be read.\n", events[found].date);
+            pthread_mutex_unlock(&dataLock);
+            return;
         }
-        eventCount--;
+        markPartitionDirty(events[found].date);
+        invalidateCache(&events[found], NULL);
+        removeEventAt(found);
+        publishChange("DELETE", NULL, id);
+        maybeCompactArena();
+        pthread_mutex_unlock(&dataLock);
+
         saveEvents();
         printf("Event deleted successfully.\n");
     }
@@ -411,7 +837,7 @@ void deleteEvent()
 
 void searchEvents()
 {
-    if (eventCount == 0)
+    if (partitionCount == 0)
     {
         printf("No events to search.\n");
         return;
@@ -422,6 +848,8 @@ void searchEvents()
     printf("1. Date\n");
     printf("2. Title\n");
     printf("3. Location\n");
+    printf("4. Suggest titles (prefix)\n");
+    printf("5. Suggest locations (prefix)\n");
     printf("Enter your choice: ");
     if (scanf("%d", &choice) != 1)
     {
@@ -431,85 +859,86 @@ void searchEvents()
     }
     clearInputBuffer(); // Consume newline
 
-    char searchTerm[100];
+    char *searchTerm = NULL;
+    TrieNode *suggestions[SUGGEST_TOP_K];
+    int suggestionCount;
+    char key[PARTITION_KEY_LEN];
+    int partition;
     int found = 0;
 
     switch (choice)
     {
     case 1: // Search by date
         printf("Enter date to search (YYYY-MM-DD): ");
-        fgets(searchTerm, sizeof(searchTerm), stdin);
-        searchTerm[strcspn(searchTerm, "\n")] = 0;
+        searchTerm = readLine();
 
         if (!validateDate(searchTerm))
         {
             printf("Invalid date format.\n");
+            free(searchTerm);
             return;
         }
 
+        // Only the month holding this date has to be read from disk, and
+        // not even that if the date falls outside the month's stored range
+        pthread_mutex_lock(&dataLock);
+        partitionKey(searchTerm, key);
+        partition = findPartition(key);
+        if (partition != -1 && strcmp(searchTerm, partitions[partition].minDate) >= 0 &&
+            strcmp(searchTerm, partitions[partition].maxDate) <= 0)
+            loadPartition(partition);
+
         printf("\n=== Events on %s ===\n", searchTerm);
         printf("ID    Title                Time   Location\n");
         printf("------------------------------------------\n");
-        for (int i = 0; i < eventCount; i++)
-        {
-            if (strcmp(events[i].date, searchTerm) == 0)
-            {
-                printf("%-5d %-20s %-6s %s\n",
-                       events[i].id, events[i].title,
-                       events[i].time, events[i].location);
-                found = 1;
-            }
-        }
+        found = printMatches('D', searchTerm);
+        pthread_mutex_unlock(&dataLock);
         break;
 
     case 2: // Search by title
         printf("Enter title to search: ");
-        fgets(searchTerm, sizeof(searchTerm), stdin);
-        searchTerm[strcspn(searchTerm, "\n")] = 0;
+        searchTerm = readLine();
         toLowerCase(searchTerm);
+        pthread_mutex_lock(&dataLock);
+        loadAllPartitions();
 
         printf("\n=== Events with '%s' in title ===\n", searchTerm);
         printf("ID    Title                Date       Time   Location\n");
         printf("----------------------------------------------------\n");
-        for (int i = 0; i < eventCount; i++)
-        {
-            char tempTitle[MAX_TITLE_LEN];
-            strcpy(tempTitle, events[i].title);
-            toLowerCase(tempTitle);
-
-            if (strstr(tempTitle, searchTerm) != NULL)
-            {
-                printf("%-5d %-20s %-10s %-6s %s\n",
-                       events[i].id, events[i].title, events[i].date,
-                       events[i].time, events[i].location);
-                found = 1;
-            }
-        }
+        found = printMatches('T', searchTerm);
+        pthread_mutex_unlock(&dataLock);
         break;
 
     case 3: // Search by location
         printf("Enter location to search: ");
-        fgets(searchTerm, sizeof(searchTerm), stdin);
-        searchTerm[strcspn(searchTerm, "\n")] = 0;
+        searchTerm = readLine();
         toLowerCase(searchTerm);
+        pthread_mutex_lock(&dataLock);
+        loadAllPartitions();
 
         printf("\n=== Events in '%s' ===\n", searchTerm);
         printf("ID    Title                Date       Time   Location\n");
         printf("----------------------------------------------------\n");
-        for (int i = 0; i < eventCount; i++)
-        {
-            char tempLocation[MAX_LOCATION_LEN];
-            strcpy(tempLocation, events[i].location);
-            toLowerCase(tempLocation);
+        found = printMatches('L', searchTerm);
+        pthread_mutex_unlock(&dataLock);
+        break;
 
-            if (strstr(tempLocation, searchTerm) != NULL)
-            {
-                printf("%-5d %-20s %-10s %-6s %s\n",
-                       events[i].id, events[i].title, events[i].date,
-                       events[i].time, events[i].location);
-                found = 1;
-            }
+    case 4: // Suggest titles
+    case 5: // Suggest locations
+        printf("Enter the start of a %s: ", choice == 4 ? "title" : "location");
+        searchTerm = readLine();
+        pthread_mutex_lock(&dataLock);
+        loadAllPartitions();
+
+        suggestionCount = trieSuggest(choice == 4 ? &titleTrie : &locationTrie,
+                                      searchTerm, suggestions);
+        printf("\n=== Suggestions for '%s' ===\n", searchTerm);
+        for (int i = 0; i < suggestionCount; i++)
+        {
+            printf("  %s (%d events)\n", suggestions[i]->text, suggestions[i]->count);
+            found = 1;
         }
+        pthread_mutex_unlock(&dataLock);
         break;
 
     default:
@@ -521,314 +950,3184 @@ void searchEvents()
     {
         printf("No events found matching your search.\n");
     }
+    free(searchTerm);
 }
 
 void saveEvents()
 {
-    FILE *file = fopen(FILENAME, "w");
+    // Replicas keep their copy in memory; the leader owns the files
+    if (isReplica)
+        return;
+
+    // Only partitions touched since the last save are rewritten
+    for (int p = 0; p < partitionCount; p++)
+    {
+        if (!partitions[p].dirty || !partitions[p].loaded || partitions[p].failed)
+            continue;
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), PARTITION_FILE_FORMAT, partitions[p].key);
+        FILE *file = fopen(filename, "w");
+        if (file == NULL)
+        {
+            printf("Error opening file for writing.\n");
+            return;
+        }
+
+        Partition *part = &partitions[p];
+        part->count = 0;
+        for (int i = 0; i < eventCount; i++)
+        {
+            if (strncmp(events[i].date, part->key, PARTITION_KEY_LEN - 1) != 0)
+                continue;
+
+            fprintf(file, "%d|%s|%s|%s|%s|%s|%d\n",
+                    events[i].id, events[i].title, events[i].date,
+                    events[i].time, events[i].location, events[i].description,
+                    events[i].capacity);
+
+            if (part->count == 0 || strcmp(events[i].date, part->minDate) < 0)
+                strcpy(part->minDate, events[i].date);
+            if (part->count == 0 || strcmp(events[i].date, part->maxDate) > 0)
+                strcpy(part->maxDate, events[i].date);
+            if (part->count == 0 || events[i].id > part->maxId)
+                part->maxId = events[i].id;
+            part->count++;
+        }
+
+        fclose(file);
+        saveAttendees(part->key);
+        part->dirty = 0;
+
+        if (part->count == 0)
+        {
+            // Drop emptied partitions so the manifest never lists them
+            remove(filename);
+            partitions[p] = partitions[--partitionCount];
+            p--;
+        }
+    }
+
+    FILE *file = fopen(MANIFEST_FILENAME, "w");
     if (file == NULL)
     {
         printf("Error opening file for writing.\n");
         return;
     }
 
-    for (int i = 0; i < eventCount; i++)
+    for (int p = 0; p < partitionCount; p++)
     {
-        fprintf(file, "%d|%s|%s|%s|%s|%s\n",
-                events[i].id, events[i].title, events[i].date,
-                events[i].time, events[i].location, events[i].description);
+        fprintf(file, "%s|%d|%s|%s|%d\n",
+                partitions[p].key, partitions[p].count,
+                partitions[p].minDate, partitions[p].maxDate,
+                partitions[p].maxId);
     }
 
     fclose(file);
+    saveIdIndex();
+    if (userEventsDirty)
+        saveUserEvents();
 }
 
 void loadEvents()
 {
-    FILE *file = fopen(FILENAME, "r");
-    if (file == NULL)
-    {
-        printf("No existing events file found. Starting fresh.\n");
-        return;
-    }
-
-    eventCount = 0;
+    // Startup only reads the manifest; partitions are loaded on demand
+    FILE *file = fopen(MANIFEST_FILENAME, "r");
     char line[500];
 
-    while (fgets(line, sizeof(line), file) && eventCount < MAX_EVENTS)
+    if (file != NULL)
     {
-        line[strcspn(line, "\n")] = 0; // Remove newline
+        int total = 0;
+        while (fgets(line, sizeof(line), file))
+        {
+            line[strcspn(line, "\n")] = 0; // Remove newline
 
-        char *token = strtok(line, "|");
-        if (token == NULL)
-            continue;
+            char *token = strtok(line, "|");
+            if (token == NULL || strlen(token) != PARTITION_KEY_LEN - 1)
+                continue;
+
+            int index = getPartition(token); // May grow the partition table
+            Partition *part = &partitions[index];
+            part->loaded = 0;
+
+            token = strtok(NULL, "|");
+            if (token)
+                part->count = atoi(token);
 
-        events[eventCount].id = atoi(token);
+            token = strtok(NULL, "|");
+            if (token)
+                strncpy(part->minDate, token, sizeof(part->minDate) - 1);
+
+            token = strtok(NULL, "|");
+            if (token)
+                strncpy(part->maxDate, token, sizeof(part->maxDate) - 1);
+
+            // Older manifests also stored a minimum id; maxId is always last
+            while ((token = strtok(NULL, "|")) != NULL)
+                part->maxId = atoi(token);
+
+            if (part->maxId >= nextEventId)
+                nextEventId = part->maxId + 1;
+            total += part->count;
+        }
 
-        token = strtok(NULL, "|");
-        if (token)
-            strcpy(events[eventCount].title, token);
+        fclose(file);
+        printf("Found %d events in %d monthly partitions.\n", total, partitionCount);
 
-        token = strtok(NULL, "|");
-        if (token)
-            strcpy(events[eventCount].date, token);
+        if (!loadIdIndex())
+        {
+            // Data saved before the id index existed: read everything once
+            if (loadAllPartitions())
+            {
+                saveIdIndex();
+                printf("Built id index for %d events.\n", eventCount);
+            }
+            else
+            {
+                idIndexPartial = 1;
+                printf("Id index incomplete; it will be rebuilt on the next start.\n");
+            }
+        }
+        loadUserEvents();
+        return;
+    }
 
-        token = strtok(NULL, "|");
-        if (token)
-            strcpy(events[eventCount].time, token);
+    // No manifest yet: migrate the old single events file if there is one
+    file = fopen(FILENAME, "r");
+    if (file == NULL)
+    {
+        printf("No existing events file found. Starting fresh.\n");
+        return;
+    }
 
-        token = strtok(NULL, "|");
-        if (token)
-            strcpy(events[eventCount].location, token);
+    char *record = NULL;
+    size_t size = 0;
+    while (getline(&record, &size, file) != -1)
+    {
+        record[strcspn(record, "\n")] = 0; // Remove newline
 
-        token = strtok(NULL, "|");
-        if (token)
-            strcpy(events[eventCount].description, token);
+        Event event;
+        if (!parseEventLine(record, &event))
+            continue;
 
-        eventCount++;
+        getPartition(event.date);
+        appendEvent(&event);
+        markPartitionDirty(event.date);
     }
 
+    free(record);
     fclose(file);
-    printf("Loaded %d events from file.\n", eventCount);
+    saveEvents();
+    printf("Loaded %d events from file into %d monthly partitions.\n", eventCount, partitionCount);
 }
 
-void eventSummary()
+void partitionKey(const char *date, char *key)
 {
-    printf("\n=== Event Summary ===\n");
-    printf("Total number of events: %d\n", eventCount);
+    // Dates are validated as YYYY-MM-DD, so the month is the first 7 chars
+    memcpy(key, date, PARTITION_KEY_LEN - 1);
+    key[PARTITION_KEY_LEN - 1] = 0;
+}
 
-    if (eventCount == 0)
-        return;
+int findPartition(const char *key)
+{
+    for (int p = 0; p < partitionCount; p++)
+    {
+        if (strncmp(partitions[p].key, key, PARTITION_KEY_LEN - 1) == 0)
+            return p;
+    }
+    return -1;
+}
 
-    // Count events by year, month, and day
-    int yearCount[100] = {0}; // Assuming events within 100 years
-    int monthCount[13] = {0}; // Index 1-12 for months
-    int dayCount[32] = {0};   // Index 1-31 for days
+int getPartition(const char *key)
+{
+    int p = findPartition(key);
+    if (p != -1)
+        return p;
 
-    int currentYear, currentMonth, currentDay;
-    for (int i = 0; i < eventCount; i++)
+    if (partitionCount == partitionCapacity)
     {
-        sscanf(events[i].date, "%d-%d-%d", &currentYear, &currentMonth, &currentDay);
-
-        // Adjust year index (assuming events between 2000-2099)
-        int yearIndex = currentYear - 2000;
-        if (yearIndex >= 0 && yearIndex < 100)
+        partitionCapacity = partitionCapacity > 0 ? partitionCapacity * 2 : 16;
+        partitions = realloc(partitions, partitionCapacity * sizeof(Partition));
+        if (partitions == NULL)
         {
-            yearCount[yearIndex]++;
+            printf("Out of memory!\n");
+            exit(1);
         }
+    }
 
-        if (currentMonth >= 1 && currentMonth <= 12)
-        {
-            monthCount[currentMonth]++;
-        }
+    // A partition that is not in the manifest has nothing on disk yet
+    Partition *part = &partitions[partitionCount];
+    memset(part, 0, sizeof(Partition));
+    partitionKey(key, part->key);
+    part->loaded = 1;
+    return partitionCount++;
+}
 
-        if (currentDay >= 1 && currentDay <= 31)
-        {
-            dayCount[currentDay]++;
-        }
-    }
+int loadPartition(int index)
+{
+    // Returns 1 once the whole month is in memory and safe to rewrite.
+    // A month that can't be opened stays unloaded and is retried next time.
+    if (partitions[index].loaded)
+        return !partitions[index].failed;
+
+    char filename[64];
+    snprintf(filename, sizeof(filename), PARTITION_FILE_FORMAT, partitions[index].key);
 
-    // Display events by year
-    printf("\nEvents by year:\n");
-    for (int i = 0; i < 100; i++)
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
     {
-        if (yearCount[i] > 0)
-        {
-            printf("  %d: %d events\n", 2000 + i, yearCount[i]);
-        }
+        printf("Error opening %s for reading.\n", filename);
+        return 0;
     }
+    partitions[index].loaded = 1;
 
-    // Display events by month
-    printf("\nEvents by month:\n");
-    char *months[] = {"", "January", "February", "March", "April", "May", "June",
-                      "July", "August", "September", "October", "November", "December"};
-    for (int i = 1; i <= 12; i++)
+    // Records can be any length now, so read them with getline
+    char *line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, file) != -1)
     {
-        if (monthCount[i] > 0)
-        {
-            printf("  %s: %d events\n", months[i], monthCount[i]);
-        }
+        line[strcspn(line, "\n")] = 0; // Remove newline
+
+        Event event;
+        if (parseEventLine(line, &event))
+            appendEvent(&event);
     }
 
-    // Display events by day
-    printf("\nEvents by day:\n");
-    for (int i = 1; i <= 31; i++)
+    if (ferror(file))
     {
-        if (dayCount[i] > 0)
-        {
-            printf("  %d: %d events\n", i, dayCount[i]);
-        }
+        // What was read stays visible, but writing it back would lose the rest
+        printf("Error reading %s.\n", filename);
+        partitions[index].failed = 1;
     }
+
+    free(line);
+    fclose(file);
+    loadAttendees(partitions[index].key);
+    return !partitions[index].failed;
 }
 
-int validateDate(const char *date)
+int loadAllPartitions()
 {
-    if (strlen(date) != 10)
-        return 0;
-    if (date[4] != '-' || date[7] != '-')
-        return 0;
+    int complete = 1;
+    for (int p = 0; p < partitionCount; p++)
+    {
+        if (!loadPartition(p))
+            complete = 0;
+    }
+    return complete;
+}
 
-    int year, month, day;
-    if (sscanf(date, "%d-%d-%d", &year, &month, &day) != 3)
-        return 0;
+void loadPartitionsForId(int id)
+{
+    // Ids follow insertion order rather than dates, so the id index names
+    // the one month holding each id
+    if (id <= 0 || id >= idMonthCapacity || idMonths[id] == 0)
+        return;
 
-    return isValidDate(day, month, year);
+    char key[PARTITION_KEY_LEN];
+    snprintf(key, sizeof(key), "%04d-%02d", idMonths[id] / 12, idMonths[id] % 12 + 1);
+    int index = findPartition(key);
+    if (index != -1)
+        loadPartition(index);
 }
 
-int isValidDate(int day, int month, int year)
+void markPartitionDirty(const char *date)
 {
-    if (year < 2000 || year > 2100)
-        return 0;
-    if (month < 1 || month > 12)
-        return 0;
-    if (day < 1 || day > 31)
-        return 0;
+    // Callers check loadPartition() first; this is the last line of defence
+    // against rewriting a month whose file wasn't fully read
+    int index = getPartition(date);
+    if (partitions[index].loaded && !partitions[index].failed)
+        partitions[index].dirty = 1;
+}
 
-    // Check for months with 30 days
-    if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30)
-        return 0;
+void setIdMonth(int id, const char *date)
+{
+    // A NULL date forgets the id
+    if (id <= 0)
+        return;
 
-    // Check for February
-    if (month == 2)
+    if (id >= idMonthCapacity)
     {
-        if (isLeapYear(year))
-        {
-            if (day > 29)
-                return 0;
-        }
-        else
+        int capacity = idMonthCapacity > 0 ? idMonthCapacity : 1024;
+        while (capacity <= id)
+            capacity *= 2;
+        idMonths = realloc(idMonths, capacity * sizeof(unsigned short));
+        if (idMonths == NULL)
         {
-            if (day > 28)
-                return 0;
+            printf("Out of memory!\n");
+            exit(1);
         }
+        memset(idMonths + idMonthCapacity, 0, (capacity - idMonthCapacity) * sizeof(unsigned short));
+        idMonthCapacity = capacity;
     }
 
-    return 1;
+    idMonths[id] = date != NULL ? atoi(date) * 12 + atoi(date + 5) - 1 : 0;
 }
 
-int isLeapYear(int year)
+int loadIdIndex()
 {
-    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-}
+    FILE *file = fopen(ID_INDEX_FILENAME, "rb");
+    if (file == NULL)
+        return 0;
 
-int validateTime(const char *time)
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+
+    int count = size / sizeof(unsigned short);
+    if (count > 0)
+    {
+        // Make room for every stored id, then read them straight in
+        setIdMonth(count - 1, NULL);
+        if (fread(idMonths, sizeof(unsigned short), count, file) != (size_t)count)
+        {
+            printf("Error reading %s.\n", ID_INDEX_FILENAME);
+            fclose(file);
+            return 0;
+        }
+    }
+
+    fclose(file);
+    return 1;
+}
+
+void saveIdIndex()
+{
+    // Two bytes per id ever assigned, so it is rewritten whole on each save
+    if (idIndexPartial)
+        return;
+
+    FILE *file = fopen(ID_INDEX_FILENAME, "wb");
+    if (file == NULL)
+    {
+        printf("Error opening file for writing.\n");
+        return;
+    }
+
+    int count = idMonthCapacity < nextEventId ? idMonthCapacity : nextEventId;
+    if (count > 0)
+        fwrite(idMonths, sizeof(unsigned short), count, file);
+    fclose(file);
+}
+
+int parseEventLine(char *line, Event *event)
+{
+    memset(event, 0, sizeof(Event));
+
+    // Fields are split by hand because strtok_r would merge the "||" of an
+    // empty description and shift the capacity into it
+    char *rest = line;
+    char *token = nextField(&rest);
+    if (token[0] == 0)
+        return 0;
+
+    event->id = atoi(token);
+
+    token = nextField(&rest);
+    event->title = arenaStrdup(token ? token : "");
+
+    token = nextField(&rest);
+    if (token)
+        strncpy(event->date, token, sizeof(event->date) - 1);
+
+    token = nextField(&rest);
+    if (token)
+        strncpy(event->time, token, sizeof(event->time) - 1);
+
+    token = nextField(&rest);
+    event->location = arenaStrdup(token ? token : "");
+
+    token = nextField(&rest);
+    event->description = arenaStrdup(token ? token : "");
+
+    // Records written before capacities existed have no seventh field
+    token = nextField(&rest);
+    if (token)
+        event->capacity = atoi(token);
+
+    if (event->id >= nextEventId)
+        nextEventId = event->id + 1;
+    return 1;
+}
+
+char *nextField(char **rest)
+{
+    // Like strtok_r with a "|" delimiter, but "a||b" yields an empty field
+    char *field = *rest;
+    if (field == NULL)
+        return NULL;
+
+    char *end = strchr(field, '|');
+    if (end != NULL)
+        *end++ = 0;
+    *rest = end;
+    return field;
+}
+
+void appendEvent(const Event *event)
+{
+    if (eventCount == eventCapacity)
+    {
+        eventCapacity = eventCapacity > 0 ? eventCapacity * 2 : 64;
+        events = realloc(events, eventCapacity * sizeof(Event));
+        if (events == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+    }
+
+    events[eventCount++] = *event;
+    indexEvent(event, 1);
+
+    if (eventCount * 2 > idSlotCapacity)
+    {
+        rebuildIdIndex(idSlotCapacity > 0 ? idSlotCapacity * 2 : 128);
+    }
+    else
+    {
+        unsigned int mask = idSlotCapacity - 1;
+        unsigned int slot = (unsigned int)event->id * 2654435761u & mask;
+        while (idSlots[slot] != 0 && events[idSlots[slot] - 1].id != event->id)
+            slot = (slot + 1) & mask;
+        if (idSlots[slot] == 0)
+            idSlots[slot] = eventCount;
+    }
+    if (event->id >= nextEventId)
+        nextEventId = event->id + 1;
+}
+
+void removeEventAt(int index)
+{
+    indexEvent(&events[index], -1);
+    releaseEventStrings(&events[index]);
+    forgetAttendees(&events[index]);
+    roaringFree(&events[index].attendees);
+
+    // Shift all events after the index to the left
+    for (int i = index; i < eventCount - 1; i++)
+    {
+        events[i] = events[i + 1];
+    }
+    eventCount--;
+
+    // Every later index moved, so the id index is rebuilt in the same pass
+    rebuildIdIndex(idSlotCapacity);
+}
+
+int findEventIndex(int id)
+{
+    loadPartitionsForId(id);
+    return lookupEventIndex(id);
+}
+
+int lookupEventIndex(int id)
+{
+    // Only searches loaded events
+    if (idSlotCapacity == 0)
+        return -1;
+
+    unsigned int mask = idSlotCapacity - 1;
+    unsigned int slot = (unsigned int)id * 2654435761u & mask;
+    while (idSlots[slot] != 0)
+    {
+        if (events[idSlots[slot] - 1].id == id)
+            return idSlots[slot] - 1;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+void rebuildIdIndex(int capacity)
+{
+    free(idSlots);
+    idSlotCapacity = capacity;
+    idSlots = calloc(capacity, sizeof(int));
+    if (idSlots == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+
+    unsigned int mask = capacity - 1;
+    for (int i = 0; i < eventCount; i++)
+    {
+        unsigned int slot = (unsigned int)events[i].id * 2654435761u & mask;
+        while (idSlots[slot] != 0 && events[idSlots[slot] - 1].id != events[i].id)
+            slot = (slot + 1) & mask;
+        if (idSlots[slot] == 0)
+            idSlots[slot] = i + 1; // Keep the first event if ids repeat
+    }
+}
+
+void startChangeFeed()
+{
+    // Replicas need the full data set, so the leader keeps every partition
+    // in memory while it publishes
+    loadAllPartitions();
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, feedSocket, sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        printf("Error creating change feed socket.\n");
+        return;
+    }
+
+    unlink(feedSocket); // Left behind if a previous leader crashed
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+        listen(fd, FEED_MAX_FOLLOWERS) == -1)
+    {
+        printf("Error listening on %s.\n", feedSocket);
+        close(fd);
+        return;
+    }
+
+    feedListener = fd;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, feedThread, NULL) != 0)
+    {
+        printf("Error starting change feed.\n");
+        close(fd);
+        unlink(feedSocket);
+        feedListener = -1;
+        return;
+    }
+    pthread_detach(thread);
+    printf("Publishing change feed on %s.\n", feedSocket);
+}
+
+void *feedThread(void *arg)
+{
+    (void)arg;
+    struct pollfd fds[FEED_MAX_FOLLOWERS + 1];
+
+    while (1)
+    {
+        // Only this thread adds or removes followers, so follower f stays at
+        // fds[f + 1] between the two locked sections below
+        pthread_mutex_lock(&dataLock);
+        time_t now = time(NULL);
+        for (int f = 0; f < followerCount; f++)
+        {
+            // A follower that stopped reading would otherwise queue forever
+            if (followers[f].pending != NULL && now - followers[f].lastProgress > FEED_STALL_SECONDS)
+                followers[f].failed = 1;
+
+            if (followers[f].failed)
+            {
+                close(followers[f].fd);
+                free(followers[f].pending);
+                followers[f--] = followers[--followerCount];
+            }
+        }
+
+        int count = 0;
+        fds[count].fd = feedListener;
+        fds[count++].events = POLLIN;
+        for (int f = 0; f < followerCount; f++)
+        {
+            fds[count].fd = followers[f].fd;
+            fds[count++].events = followers[f].pending != NULL ? POLLIN | POLLOUT : POLLIN;
+        }
+        pthread_mutex_unlock(&dataLock);
+
+        // Wake up periodically to pick up followers dropped by publishChange
+        if (poll(fds, count, 1000) <= 0)
+            continue;
+
+        pthread_mutex_lock(&dataLock);
+        for (int i = 1; i < count; i++)
+        {
+            Follower *follower = &followers[i - 1];
+            if (fds[i].revents & POLLOUT)
+                flushOutput(follower);
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            char buffer[256];
+            ssize_t length = recv(follower->fd, buffer, sizeof(buffer) - 1, 0);
+            if (length == -1 && (errno == EAGAIN || errno == EINTR))
+                continue;
+            if (length <= 0)
+            {
+                follower->failed = 1;
+                continue;
+            }
+            buffer[length] = 0;
+
+            // Followers send "ACK <sequence>" lines; only the newest complete
+            // one matters, a partial line is superseded by the next ack
+            char *end = strrchr(buffer, '\n');
+            if (end == NULL)
+                continue;
+            *end = 0;
+            char *ack = strrchr(buffer, '\n');
+            ack = ack != NULL ? ack + 1 : buffer;
+            if (strncmp(ack, "ACK ", 4) == 0)
+            {
+                follower->ackedSequence = atol(ack + 4);
+                follower->lastAck = time(NULL);
+            }
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept(feedListener, NULL, NULL);
+            if (fd != -1 && followerCount == FEED_MAX_FOLLOWERS)
+            {
+                close(fd);
+            }
+            else if (fd != -1)
+            {
+                Follower *follower = &followers[followerCount++];
+                memset(follower, 0, sizeof(Follower));
+                follower->fd = fd;
+                follower->connectedAt = time(NULL);
+                follower->lastAck = follower->connectedAt;
+                follower->lastProgress = follower->connectedAt;
+
+                // Catch the new follower up from a snapshot, then stream
+                // changes. The socket never blocks while dataLock is held:
+                // what it won't take yet is queued, and a follower that stops
+                // reading is dropped and resyncs when it reconnects
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                sendSnapshot(follower);
+            }
+        }
+        pthread_mutex_unlock(&dataLock);
+    }
+
+    return NULL;
+}
+
+void sendSnapshot(Follower *follower)
+{
+    char buffer[65536];
+    int used = snprintf(buffer, sizeof(buffer), "SNAPSHOT %ld %d\n", feedSequence, eventCount);
+
+    for (int i = 0; i < eventCount && !follower->failed; i++)
+    {
+        char *line = formatEventLine(&events[i]);
+        size_t length = strlen(line);
+
+        // Batch records into large writes instead of one send per event
+        if (used + length + 1 > sizeof(buffer))
+        {
+            queueOutput(follower, buffer, used);
+            used = 0;
+        }
+        if (length + 1 > sizeof(buffer))
+        {
+            queueOutput(follower, line, length);
+            queueOutput(follower, "\n", 1);
+        }
+        else
+        {
+            memcpy(buffer + used, line, length);
+            buffer[used + length] = '\n';
+            used += length + 1;
+        }
+        free(line);
+    }
+
+    queueOutput(follower, buffer, used);
+}
+
+void publishChange(const char *operation, const Event *event, int id)
+{
+    // Called with dataLock held, right after events[] has been changed
+    if (feedListener == -1)
+        return;
+
+    feedSequence++;
+
+    char *message;
+    if (event != NULL)
+    {
+        char *line = formatEventLine(event);
+        size_t length = strlen(operation) + strlen(line) + 32;
+        message = malloc(length);
+        if (message != NULL)
+            snprintf(message, length, "%s %ld %s\n", operation, feedSequence, line);
+        free(line);
+    }
+    else
+    {
+        message = malloc(64);
+        if (message != NULL)
+            snprintf(message, 64, "%s %ld %d\n", operation, feedSequence, id);
+    }
+
+    if (message == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+
+    for (int f = 0; f < followerCount; f++)
+    {
+        queueOutput(&followers[f], message, strlen(message));
+    }
+    free(message);
+}
+
+void queueOutput(Follower *follower, const char *data, size_t length)
+{
+    // Called with dataLock held. Sends what the socket takes right away and
+    // queues the rest behind anything already waiting, keeping order intact
+    if (follower->failed)
+        return;
+
+    if (follower->pending == NULL)
+    {
+        while (length > 0)
+        {
+            ssize_t sent = send(follower->fd, data, length, MSG_NOSIGNAL);
+            if (sent == -1 && errno == EINTR)
+                continue;
+            if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (sent <= 0)
+            {
+                follower->failed = 1;
+                return;
+            }
+            data += sent;
+            length -= sent;
+        }
+        if (length == 0)
+            return;
+        follower->lastProgress = time(NULL);
+    }
+
+    if (follower->pendingLength + length > follower->pendingCapacity)
+    {
+        size_t capacity = follower->pendingCapacity > 0 ? follower->pendingCapacity : 65536;
+        while (capacity < follower->pendingLength + length)
+            capacity *= 2;
+        follower->pending = realloc(follower->pending, capacity);
+        if (follower->pending == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        follower->pendingCapacity = capacity;
+    }
+    memcpy(follower->pending + follower->pendingLength, data, length);
+    follower->pendingLength += length;
+}
+
+void flushOutput(Follower *follower)
+{
+    // Called by the feed thread with dataLock held once the socket is writable
+    while (!follower->failed && follower->pendingSent < follower->pendingLength)
+    {
+        ssize_t sent = send(follower->fd, follower->pending + follower->pendingSent,
+                            follower->pendingLength - follower->pendingSent, MSG_NOSIGNAL);
+        if (sent == -1 && errno == EINTR)
+            continue;
+        if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (sent <= 0)
+        {
+            follower->failed = 1;
+            return;
+        }
+        follower->pendingSent += sent;
+        follower->lastProgress = time(NULL);
+    }
+
+    free(follower->pending);
+    follower->pending = NULL;
+    follower->pendingLength = 0;
+    follower->pendingCapacity = 0;
+    follower->pendingSent = 0;
+}
+
+void startReplica()
+{
+    printf("Following change feed on %s...\n", feedSocket);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, replicaThread, NULL) != 0)
+    {
+        printf("Error starting replica.\n");
+        exit(1);
+    }
+    pthread_detach(thread);
+
+    // Give the leader a moment to send its snapshot before showing the menu
+    struct timespec pause = {0, 100000000}; // 100 ms
+    int connected = 0;
+    for (int i = 0; i < 50 && !connected; i++)
+    {
+        nanosleep(&pause, NULL);
+        pthread_mutex_lock(&dataLock);
+        connected = replicaConnected;
+        pthread_mutex_unlock(&dataLock);
+    }
+
+    if (connected)
+        printf("Replica caught up with %d events.\n", eventCount);
+    else
+        printf("Leader not reachable yet; retrying in the background.\n");
+}
+
+void *replicaThread(void *arg)
+{
+    (void)arg;
+
+    while (1)
+    {
+        int fd = connectToFeed();
+        if (fd == -1)
+        {
+            sleep(1);
+            continue;
+        }
+
+        FILE *feed = fdopen(fd, "r");
+        char *line = NULL;
+        size_t size = 0;
+        while (feed != NULL && getline(&line, &size, feed) != -1)
+        {
+            line[strcspn(line, "\n")] = 0;
+            if (!applyChange(line, feed))
+                break; // Incomplete snapshot: start over on a new connection
+
+            // Report progress so the leader can track this replica's lag
+            char ack[32];
+            int length = snprintf(ack, sizeof(ack), "ACK %ld\n", replicaSequence);
+            sendAll(fd, ack, length);
+        }
+        free(line);
+        if (feed != NULL)
+            fclose(feed);
+        else
+            close(fd);
+
+        // Reconnecting starts over from a fresh snapshot
+        pthread_mutex_lock(&dataLock);
+        replicaConnected = 0;
+        pthread_mutex_unlock(&dataLock);
+        sleep(1);
+    }
+
+    return NULL;
+}
+
+int connectToFeed()
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, feedSocket, sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        return -1;
+
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int applyChange(char *line, FILE *feed)
+{
+    // Returns 0 if the connection has to be dropped
+    char *rest;
+    char *operation = strtok_r(line, " ", &rest);
+    char *sequence = strtok_r(NULL, " ", &rest);
+    if (operation == NULL || sequence == NULL)
+        return 1;
+
+    if (strcmp(operation, "SNAPSHOT") == 0)
+        return applySnapshot(feed, atoi(rest), atol(sequence));
+
+    Event event;
+    pthread_mutex_lock(&dataLock);
+
+    if (strcmp(operation, "ADD") == 0 && parseEventLine(rest, &event))
+    {
+        getPartition(event.date);
+        appendEvent(&event);
+        invalidateCache(NULL, &event);
+    }
+    else if (strcmp(operation, "EDIT") == 0 && parseEventLine(rest, &event))
+    {
+        int index = findEventIndex(event.id);
+        if (index != -1)
+        {
+            getPartition(event.date);
+            indexEvent(&events[index], -1);
+            indexEvent(&event, 1);
+            invalidateCache(&events[index], &event);
+            releaseEventStrings(&events[index]);
+            event.attendees = events[index].attendees; // Not part of the feed
+            events[index] = event;
+        }
+        else
+        {
+            releaseEventStrings(&event);
+        }
+    }
+    else if (strcmp(operation, "DELETE") == 0)
+    {
+        int index = findEventIndex(atoi(rest));
+        if (index != -1)
+        {
+            invalidateCache(&events[index], NULL);
+            removeEventAt(index);
+        }
+    }
+
+    replicaSequence = atol(sequence);
+    replicaLastUpdate = time(NULL);
+    maybeCompactArena();
+    pthread_mutex_unlock(&dataLock);
+    return 1;
+}
+
+int applySnapshot(FILE *feed, int count, long sequence)
+{
+    // Read the whole snapshot before taking dataLock, so a slow or stalled
+    // leader never blocks the menu, and only replace the replica's data once
+    // every record has arrived
+    struct timeval timeout = {FEED_SNAPSHOT_TIMEOUT, 0};
+    setsockopt(fileno(feed), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char **records = NULL;
+    int received = 0;
+    int capacity = 0;
+    char *record = NULL;
+    size_t size = 0;
+    while (received < count && getline(&record, &size, feed) != -1)
+    {
+        if (received == capacity)
+        {
+            capacity = capacity > 0 ? capacity * 2 : 1024;
+            records = realloc(records, capacity * sizeof(char *));
+            if (records == NULL)
+            {
+                printf("Out of memory!\n");
+                exit(1);
+            }
+        }
+        record[strcspn(record, "\n")] = 0;
+        records[received++] = record;
+        record = NULL;
+        size = 0;
+    }
+    free(record);
+
+    // Changes may be minutes apart, so only the snapshot has a deadline
+    timeout.tv_sec = 0;
+    setsockopt(fileno(feed), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int complete = received == count;
+    if (complete)
+    {
+        // Parsing allocates from the shared arena, so it happens under the lock
+        pthread_mutex_lock(&dataLock);
+        for (int i = 0; i < eventCount; i++)
+        {
+            indexEvent(&events[i], -1);
+            releaseEventStrings(&events[i]);
+            roaringFree(&events[i].attendees);
+        }
+        eventCount = 0;
+        partitionCount = 0;
+        invalidateCache(NULL, NULL);
+        if (idSlotCapacity > 0)
+            rebuildIdIndex(idSlotCapacity);
+
+        Event event;
+        for (int i = 0; i < count; i++)
+        {
+            if (parseEventLine(records[i], &event))
+            {
+                getPartition(event.date);
+                appendEvent(&event);
+            }
+        }
+
+        replicaConnected = 1;
+        replicaSequence = sequence;
+        replicaLastUpdate = time(NULL);
+        maybeCompactArena();
+        pthread_mutex_unlock(&dataLock);
+    }
+
+    for (int i = 0; i < received; i++)
+    {
+        free(records[i]);
+    }
+    free(records);
+    return complete;
+}
+
+int sendAll(int fd, const char *buffer, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, buffer, length, MSG_NOSIGNAL);
+        if (sent == -1 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return 0;
+        buffer += sent;
+        length -= sent;
+    }
+    return 1;
+}
+
+char *formatEventLine(const Event *event)
+{
+    // Same record layout as the partition files
+    int length = snprintf(NULL, 0, "%d|%s|%s|%s|%s|%s|%d",
+                          event->id, event->title, event->date,
+                          event->time, event->location, event->description,
+                          event->capacity);
+    char *line = malloc(length + 1);
+    if (line == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+    snprintf(line, length + 1, "%d|%s|%s|%s|%s|%s|%d",
+             event->id, event->title, event->date,
+             event->time, event->location, event->description,
+             event->capacity);
+    return line;
+}
+
+void replicationStatus()
+{
+    printf("\n=== Replication Status ===\n");
+    pthread_mutex_lock(&dataLock);
+
+    if (isReplica)
+    {
+        printf("Role: read replica of %s\n", feedSocket);
+        printf("Connection: %s\n", replicaConnected ? "connected" : "disconnected, retrying");
+        printf("Applied sequence: %ld\n", replicaSequence);
+        if (replicaLastUpdate > 0)
+            printf("Last change received: %lds ago\n", (long)(time(NULL) - replicaLastUpdate));
+        printf("Events in replica: %d\n", eventCount);
+    }
+    else if (feedListener != -1)
+    {
+        time_t now = time(NULL);
+        printf("Role: leader, publishing on %s\n", feedSocket);
+        printf("Current sequence: %ld\n", feedSequence);
+        printf("\nFollower  Acked      Lag (changes)  Last ack   Connected\n");
+        printf("----------------------------------------------------------\n");
+        int shown = 0;
+        for (int f = 0; f < followerCount; f++)
+        {
+            if (followers[f].failed)
+                continue;
+            char lastAck[32];
+            snprintf(lastAck, sizeof(lastAck), "%lds ago", (long)(now - followers[f].lastAck));
+            printf("%-9d %-10ld %-14ld %-10s %lds ago\n",
+                   ++shown, followers[f].ackedSequence,
+                   feedSequence - followers[f].ackedSequence,
+                   lastAck, (long)(now - followers[f].connectedAt));
+        }
+        if (shown == 0)
+            printf("No followers connected.\n");
+    }
+    else
+    {
+        printf("Replication is off. Start with --feed to publish changes\n");
+        printf("or with --follow to run as a read replica.\n");
+    }
+
+    pthread_mutex_unlock(&dataLock);
+}
+
+int printMatches(char mode, const char *term)
+{
+    // Called with dataLock held. A cached entry holds event ids rather than
+    // rows, so edits that don't affect matching still show up when printed.
+    CacheEntry *cached = cacheLookup(mode, term);
+    int *ids;
+    int idCount = 0;
+
+    if (cached != NULL)
+    {
+        ids = cached->ids;
+        idCount = cached->idCount;
+    }
+    else
+    {
+        int capacity = 16;
+        ids = malloc(capacity * sizeof(int));
+        for (int i = 0; i < eventCount && ids != NULL; i++)
+        {
+            if (!eventMatches(mode, term, &events[i]))
+                continue;
+
+            if (idCount == capacity)
+            {
+                capacity *= 2;
+                int *grown = realloc(ids, capacity * sizeof(int));
+                if (grown == NULL)
+                {
+                    free(ids);
+                    ids = NULL;
+                    break;
+                }
+                ids = grown;
+            }
+            ids[idCount++] = events[i].id;
+        }
+
+        if (ids == NULL)
+        {
+            printf("Out of memory!\n");
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < idCount; i++)
+    {
+        int index = lookupEventIndex(ids[i]);
+        if (index == -1)
+            continue;
+
+        if (mode == 'D')
+            printf("%-5d %-20s %-6s %s\n",
+                   events[index].id, events[index].title,
+                   events[index].time, events[index].location);
+        else
+            printf("%-5d %-20s %-10s %-6s %s\n",
+                   events[index].id, events[index].title, events[index].date,
+                   events[index].time, events[index].location);
+    }
+
+    // The cache takes ownership of a fresh result
+    if (cached == NULL)
+        cacheStore(mode, term, ids, idCount, NULL);
+    return idCount > 0;
+}
+
+CacheEntry *cacheLookup(char mode, const char *term)
+{
+    unsigned int bucket = (hashText(term) ^ (unsigned char)mode) % CACHE_BUCKETS;
+    for (CacheEntry *entry = cacheBuckets[bucket]; entry != NULL; entry = entry->chain)
+    {
+        if (entry->mode != mode || strcmp(entry->term, term) != 0)
+            continue;
+
+        // Move to the front of the LRU list
+        if (entry != cacheNewest)
+        {
+            entry->newer->older = entry->older;
+            if (entry->older != NULL)
+                entry->older->newer = entry->newer;
+            else
+                cacheOldest = entry->newer;
+            entry->newer = NULL;
+            entry->older = cacheNewest;
+            cacheNewest->newer = entry;
+            cacheNewest = entry;
+        }
+        cacheHits++;
+        return entry;
+    }
+
+    cacheMisses++;
+    return NULL;
+}
+
+void cacheStore(char mode, const char *term, int *ids, int idCount, SummaryPartial *summary)
+{
+    size_t bytes = sizeof(CacheEntry) + strlen(term) + 1 + idCount * sizeof(int);
+    if (summary != NULL)
+        bytes += sizeof(SummaryPartial) + summary->locationCapacity * sizeof(LocationCount);
+
+    CacheEntry *entry = bytes <= CACHE_BUDGET_BYTES ? calloc(1, sizeof(CacheEntry)) : NULL;
+    if (entry == NULL || (entry->term = strdup(term)) == NULL)
+    {
+        // Too large to cache (or no memory): just drop the result
+        free(entry);
+        free(ids);
+        if (summary != NULL)
+            free(summary->locations);
+        free(summary);
+        return;
+    }
+
+    // Evict least recently used entries until the new one fits the budget
+    while (cacheOldest != NULL && cacheBytes + bytes > CACHE_BUDGET_BYTES)
+    {
+        cacheRemove(cacheOldest);
+        cacheEvictions++;
+    }
+
+    unsigned int bucket = (hashText(term) ^ (unsigned char)mode) % CACHE_BUCKETS;
+    entry->mode = mode;
+    entry->ids = ids;
+    entry->idCount = idCount;
+    entry->summary = summary;
+    entry->bytes = bytes;
+    entry->chain = cacheBuckets[bucket];
+    cacheBuckets[bucket] = entry;
+    entry->older = cacheNewest;
+    if (cacheNewest != NULL)
+        cacheNewest->newer = entry;
+    else
+        cacheOldest = entry;
+    cacheNewest = entry;
+    cacheBytes += bytes;
+    cacheEntries++;
+}
+
+void cacheRemove(CacheEntry *entry)
+{
+    unsigned int bucket = (hashText(entry->term) ^ (unsigned char)entry->mode) % CACHE_BUCKETS;
+    CacheEntry **link = &cacheBuckets[bucket];
+    while (*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+
+    if (entry->newer != NULL)
+        entry->newer->older = entry->older;
+    else
+        cacheNewest = entry->older;
+    if (entry->older != NULL)
+        entry->older->newer = entry->newer;
+    else
+        cacheOldest = entry->newer;
+
+    cacheBytes -= entry->bytes;
+    cacheEntries--;
+    free(entry->term);
+    free(entry->ids);
+    if (entry->summary != NULL)
+        free(entry->summary->locations);
+    free(entry->summary);
+    free(entry);
+}
+
+void invalidateCache(const Event *oldEvent, const Event *newEvent)
+{
+    // Drop only the searches the old or new version of the event could match.
+    // Summaries depend on every event, so any change drops them; passing two
+    // NULLs (a replica snapshot) drops everything.
+    CacheEntry *entry = cacheNewest;
+    while (entry != NULL)
+    {
+        CacheEntry *older = entry->older;
+        if (entry->mode == 'S' || (oldEvent == NULL && newEvent == NULL) ||
+            (oldEvent != NULL && eventMatches(entry->mode, entry->term, oldEvent)) ||
+            (newEvent != NULL && eventMatches(entry->mode, entry->term, newEvent)))
+        {
+            cacheRemove(entry);
+            cacheInvalidations++;
+        }
+        entry = older;
+    }
+}
+
+void invalidateSummaries()
+{
+    // Cached summaries point at location strings in the arena
+    CacheEntry *entry = cacheNewest;
+    while (entry != NULL)
+    {
+        CacheEntry *older = entry->older;
+        if (entry->mode == 'S')
+        {
+            cacheRemove(entry);
+            cacheInvalidations++;
+        }
+        entry = older;
+    }
+}
+
+int eventMatches(char mode, const char *term, const Event *event)
+{
+    switch (mode)
+    {
+    case 'D':
+        return strcmp(event->date, term) == 0;
+    case 'T':
+        return containsIgnoreCase(event->title, term);
+    case 'L':
+        return containsIgnoreCase(event->location, term);
+    default:
+        return 1;
+    }
+}
+
+void cacheStatus()
+{
+    pthread_mutex_lock(&dataLock);
+    long lookups = cacheHits + cacheMisses;
+    printf("\n=== Query Cache ===\n");
+    printf("Entries: %d using %zu bytes (budget %d KB)\n", cacheEntries, cacheBytes, CACHE_BUDGET_BYTES / 1024);
+    printf("Hits: %ld, misses: %ld, hit rate: %.1f%%\n", cacheHits, cacheMisses,
+           lookups > 0 ? 100.0 * cacheHits / lookups : 0.0);
+    printf("Evictions: %ld, invalidations: %ld\n", cacheEvictions, cacheInvalidations);
+    pthread_mutex_unlock(&dataLock);
+}
+
+void eventSummary()
+{
+    pthread_mutex_lock(&dataLock);
+    loadAllPartitions();
+    int total = eventCount;
+    pthread_mutex_unlock(&dataLock);
+
+    printf("\n=== Event Summary ===\n");
+    printf("Total number of events: %d\n", total);
+
+    if (total == 0)
+        return;
+
+    int choice;
+    printf("\nSummarize by:\n");
+    printf("1. Year, month and day\n");
+    printf("2. Year-month\n");
+    printf("3. Weekday\n");
+    printf("4. Hour of day\n");
+    printf("5. Location\n");
+    printf("6. Top %d busiest locations\n", SUMMARY_TOP_K);
+    printf("Enter your choice: ");
+    if (scanf("%d", &choice) != 1)
+    {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline
+
+    if (choice < 1 || choice > 6)
+    {
+        printf("Invalid choice.\n");
+        return;
+    }
+
+    pthread_mutex_lock(&dataLock);
+    char term[2] = {(char)('0' + choice), 0};
+    CacheEntry *cached = cacheLookup('S', term);
+    SummaryPartial *summary = cached != NULL ? cached->summary : computeSummary(choice);
+    if (summary == NULL)
+    {
+        pthread_mutex_unlock(&dataLock);
+        printf("Out of memory!\n");
+        return;
+    }
+
+    char *months[] = {"", "January", "February", "March", "April", "May", "June",
+                      "July", "August", "September", "October", "November", "December"};
+
+    switch (choice)
+    {
+    case 1:
+    {
+        // Display events by year
+        printf("\nEvents by year:\n");
+        for (int y = 0; y < SUMMARY_YEARS; y++)
+        {
+            int count = 0;
+            for (int m = 0; m < 12; m++)
+            {
+                count += summary->yearMonthCount[y * 12 + m];
+            }
+            if (count > 0)
+            {
+                printf("  %d: %d events\n", SUMMARY_MIN_YEAR + y, count);
+            }
+        }
+
+        // Display events by month
+        printf("\nEvents by month:\n");
+        for (int m = 0; m < 12; m++)
+        {
+            int count = 0;
+            for (int y = 0; y < SUMMARY_YEARS; y++)
+            {
+                count += summary->yearMonthCount[y * 12 + m];
+            }
+            if (count > 0)
+            {
+                printf("  %s: %d events\n", months[m + 1], count);
+            }
+        }
+
+        // Display events by day
+        printf("\nEvents by day:\n");
+        for (int i = 1; i <= 31; i++)
+        {
+            if (summary->dayCount[i] > 0)
+            {
+                printf("  %d: %d events\n", i, summary->dayCount[i]);
+            }
+        }
+        break;
+    }
+
+    case 2:
+        printf("\nEvents by year-month:\n");
+        for (int i = 0; i < SUMMARY_YEARS * 12; i++)
+        {
+            if (summary->yearMonthCount[i] > 0)
+            {
+                printf("  %d-%02d: %d events\n", SUMMARY_MIN_YEAR + i / 12, i % 12 + 1,
+                       summary->yearMonthCount[i]);
+            }
+        }
+        break;
+
+    case 3:
+    {
+        char *weekdays[] = {"Sunday", "Monday", "Tuesday", "Wednesday",
+                            "Thursday", "Friday", "Saturday"};
+        printf("\nEvents by weekday:\n");
+        for (int i = 0; i < 7; i++)
+        {
+            if (summary->weekdayCount[i] > 0)
+            {
+                printf("  %s: %d events\n", weekdays[i], summary->weekdayCount[i]);
+            }
+        }
+        break;
+    }
+
+    case 4:
+        printf("\nEvents by hour of day:\n");
+        for (int i = 0; i < 24; i++)
+        {
+            if (summary->hourCount[i] > 0)
+            {
+                printf("  %02d:00: %d events\n", i, summary->hourCount[i]);
+            }
+        }
+        break;
+
+    case 5:
+        printf("\nEvents by location:\n");
+        for (int i = 0; i < summary->locationCount; i++)
+        {
+            printf("  %s: %d events\n", summary->locations[i].location, summary->locations[i].count);
+        }
+        break;
+
+    case 6:
+        // Space-Saving counts can overestimate; mark those with '~'
+        printf("\nTop %d busiest locations:\n", SUMMARY_TOP_K);
+        for (int i = 0; i < summary->sketchCount && i < SUMMARY_TOP_K; i++)
+        {
+            printf("  %s: %s%d events\n", summary->sketch[i].location,
+                   summary->sketch[i].error > 0 ? "~" : "", summary->sketch[i].count);
+        }
+        break;
+    }
+
+    // The cache takes ownership of a freshly computed summary
+    if (cached == NULL)
+        cacheStore('S', term, NULL, 0, summary);
+    pthread_mutex_unlock(&dataLock);
+}
+
+SummaryPartial *computeSummary(int choice)
+{
+    // Split the array into one slice per thread; each thread fills its own
+    // histograms so there is no sharing until the final merge
+    int threadCount = eventCount / SUMMARY_EVENTS_PER_THREAD;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0 && threadCount > cpus)
+        threadCount = (int)cpus;
+    if (threadCount > SUMMARY_MAX_THREADS)
+        threadCount = SUMMARY_MAX_THREADS;
+    if (threadCount < 1)
+        threadCount = 1;
+
+    SummaryPartial *partials = calloc(threadCount, sizeof(SummaryPartial));
+    pthread_t threads[SUMMARY_MAX_THREADS];
+    if (partials == NULL)
+        return NULL;
+
+    for (int t = 0; t < threadCount; t++)
+    {
+        partials[t].start = (int)((long)eventCount * t / threadCount);
+        partials[t].end = (int)((long)eventCount * (t + 1) / threadCount);
+        partials[t].trackLocations = choice == 5;
+        partials[t].trackTopLocations = choice == 6;
+    }
+
+    // Slice 0 runs on this thread; fall back to it if a thread can't start
+    int started[SUMMARY_MAX_THREADS] = {0};
+    for (int t = 1; t < threadCount; t++)
+    {
+        started[t] = pthread_create(&threads[t], NULL, summarizeRange, &partials[t]) == 0;
+    }
+    summarizeRange(&partials[0]);
+    for (int t = 1; t < threadCount; t++)
+    {
+        if (started[t])
+            pthread_join(threads[t], NULL);
+        else
+            summarizeRange(&partials[t]);
+        mergeSummary(&partials[0], &partials[t]);
+        free(partials[t].locations);
+    }
+
+    // Sort the results now so a cached summary can be printed as is
+    SummaryPartial *summary = malloc(sizeof(SummaryPartial));
+    if (summary == NULL)
+    {
+        free(partials[0].locations);
+        free(partials);
+        return NULL;
+    }
+    *summary = partials[0];
+    free(partials);
+
+    int n = 0;
+    for (int i = 0; i < summary->locationCapacity; i++)
+    {
+        if (summary->locations[i].location != NULL)
+            summary->locations[n++] = summary->locations[i];
+    }
+    summary->locationCount = n;
+    // Summaries that skip locations have no table to sort
+    if (n > 0)
+        qsort(summary->locations, n, sizeof(LocationCount), compareLocationCounts);
+    if (summary->sketchCount > 0)
+        qsort(summary->sketch, summary->sketchCount, sizeof(LocationCount), compareLocationCounts);
+    return summary;
+}
+
+void *summarizeRange(void *arg)
+{
+    SummaryPartial *partial = arg;
+
+    for (int i = partial->start; i < partial->end; i++)
+    {
+        // Dates and times are stored as validated YYYY-MM-DD and HH:MM,
+        // so the fields can be read from fixed offsets without sscanf
+        const char *d = events[i].date;
+        const char *t = events[i].time;
+        if (!isdigit((unsigned char)d[0]) || !isdigit((unsigned char)d[1]) ||
+            !isdigit((unsigned char)d[2]) || !isdigit((unsigned char)d[3]) ||
+            !isdigit((unsigned char)d[5]) || !isdigit((unsigned char)d[6]) ||
+            !isdigit((unsigned char)d[8]) || !isdigit((unsigned char)d[9]))
+            continue;
+
+        int year = (d[0] - '0') * 1000 + (d[1] - '0') * 100 + (d[2] - '0') * 10 + (d[3] - '0');
+        int month = (d[5] - '0') * 10 + (d[6] - '0');
+        int day = (d[8] - '0') * 10 + (d[9] - '0');
+
+        int yearIndex = year - SUMMARY_MIN_YEAR;
+        if (yearIndex >= 0 && yearIndex < SUMMARY_YEARS && month >= 1 && month <= 12)
+        {
+            partial->yearMonthCount[yearIndex * 12 + month - 1]++;
+            partial->weekdayCount[dayOfWeek(year, month, day)]++;
+        }
+
+        if (day >= 1 && day <= 31)
+        {
+            partial->dayCount[day]++;
+        }
+
+        if (isdigit((unsigned char)t[0]) && isdigit((unsigned char)t[1]))
+        {
+            int hour = (t[0] - '0') * 10 + (t[1] - '0');
+            if (hour < 24)
+                partial->hourCount[hour]++;
+        }
+
+        if (partial->trackLocations)
+            countLocation(partial, events[i].location, 1);
+        if (partial->trackTopLocations)
+            sketchLocation(partial, events[i].location, 1, 0);
+    }
+
+    return NULL;
+}
+
+void mergeSummary(SummaryPartial *into, const SummaryPartial *from)
+{
+    for (int i = 0; i < SUMMARY_YEARS * 12; i++)
+    {
+        into->yearMonthCount[i] += from->yearMonthCount[i];
+    }
+    for (int i = 0; i < 32; i++)
+    {
+        into->dayCount[i] += from->dayCount[i];
+    }
+    for (int i = 0; i < 7; i++)
+    {
+        into->weekdayCount[i] += from->weekdayCount[i];
+    }
+    for (int i = 0; i < 24; i++)
+    {
+        into->hourCount[i] += from->hourCount[i];
+    }
+
+    for (int i = 0; i < from->locationCapacity; i++)
+    {
+        if (from->locations[i].location != NULL)
+            countLocation(into, from->locations[i].location, from->locations[i].count);
+    }
+
+    // Space-Saving summaries merge by feeding one sketch's counters into
+    // the other, which keeps the result within the same fixed size
+    for (int i = 0; i < from->sketchCount; i++)
+    {
+        sketchLocation(into, from->sketch[i].location, from->sketch[i].count, from->sketch[i].error);
+    }
+}
+
+void countLocation(SummaryPartial *partial, const char *location, int count)
+{
+    if (partial->locationCount * 2 >= partial->locationCapacity)
+    {
+        // Grow and rehash to keep the table at most half full
+        int oldCapacity = partial->locationCapacity;
+        LocationCount *old = partial->locations;
+        partial->locationCapacity = oldCapacity > 0 ? oldCapacity * 2 : 64;
+        partial->locations = calloc(partial->locationCapacity, sizeof(LocationCount));
+        if (partial->locations == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        partial->locationCount = 0;
+        for (int i = 0; i < oldCapacity; i++)
+        {
+            if (old[i].location != NULL)
+                countLocation(partial, old[i].location, old[i].count);
+        }
+        free(old);
+    }
+
+    unsigned int mask = partial->locationCapacity - 1;
+    unsigned int slot = hashText(location) & mask;
+    while (partial->locations[slot].location != NULL)
+    {
+        if (strcasecmp(partial->locations[slot].location, location) == 0)
+        {
+            partial->locations[slot].count += count;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    partial->locations[slot].location = location;
+    partial->locations[slot].count = count;
+    partial->locationCount++;
+}
+
+void sketchLocation(SummaryPartial *partial, const char *location, int count, int error)
+{
+    int minIndex = 0;
+    for (int i = 0; i < partial->sketchCount; i++)
+    {
+        if (strcasecmp(partial->sketch[i].location, location) == 0)
+        {
+            partial->sketch[i].count += count;
+            partial->sketch[i].error += error;
+            return;
+        }
+        if (partial->sketch[i].count < partial->sketch[minIndex].count)
+            minIndex = i;
+    }
+
+    if (partial->sketchCount < SUMMARY_SKETCH_SIZE)
+    {
+        LocationCount *entry = &partial->sketch[partial->sketchCount++];
+        entry->location = location;
+        entry->count = count;
+        entry->error = error;
+        return;
+    }
+
+    // Full: evict the smallest counter and inherit its count as error
+    LocationCount *entry = &partial->sketch[minIndex];
+    int evicted = entry->count;
+    entry->location = location;
+    entry->count = evicted + count;
+    entry->error = evicted + error;
+}
+
+int compareLocationCounts(const void *a, const void *b)
+{
+    const LocationCount *x = a;
+    const LocationCount *y = b;
+    if (x->count != y->count)
+        return y->count - x->count;
+    return strcasecmp(x->location, y->location);
+}
+
+unsigned int hashText(const char *text)
+{
+    // FNV-1a over the lowercased bytes so case variants share a bucket
+    unsigned int hash = 2166136261u;
+    for (int i = 0; text[i]; i++)
+    {
+        hash ^= (unsigned char)tolower((unsigned char)text[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int dayOfWeek(int year, int month, int day)
+{
+    // Sakamoto's method, 0 = Sunday
+    static const int offsets[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    if (month < 3)
+        year--;
+    return (year + year / 4 - year / 100 + year / 400 + offsets[month - 1] + day) % 7;
+}
+
+int validateDate(const char *date)
+{
+    if (strlen(date) != 10)
+        return 0;
+    if (date[4] != '-' || date[7] != '-')
+        return 0;
+
+    int year, month, day;
+    if (sscanf(date, "%d-%d-%d", &year, &month, &day) != 3)
+        return 0;
+
+    return isValidDate(day, month, year);
+}
+
+int isValidDate(int day, int month, int year)
+{
+    if (year < 2000 || year > 2100)
+        return 0;
+    if (month < 1 || month > 12)
+        return 0;
+    if (day < 1 || day > 31)
+        return 0;
+
+    // Check for months with 30 days
+    if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30)
+        return 0;
+
+    // Check for February
+    if (month == 2)
+    {
+        if (isLeapYear(year))
+        {
+            if (day > 29)
+                return 0;
+        }
+        else
+        {
+            if (day > 28)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+int isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+int validateTime(const char *time)
+{
+    if (strlen(time) != 5)
+        return 0;
+    if (time[2] != ':')
+        return 0;
+
+    int hour, minute;
+    if (sscanf(time, "%d:%d", &hour, &minute) != 2)
+        return 0;
+
+    if (hour < 0 || hour > 23)
+        return 0;
+    if (minute < 0 || minute > 59)
+        return 0;
+
+    return 1;
+}
+
+void toLowerCase(char *str)
+{
+    for (int i = 0; str[i]; i++)
+    {
+        str[i] = tolower(str[i]);
+    }
+}
+
+char *readLine()
+{
+    // Reads a whole line of any length; the caller frees it
+    char *line = NULL;
+    size_t size = 0;
+    if (getline(&line, &size, stdin) == -1)
+    {
+        free(line);
+        line = malloc(1);
+        if (line == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        line[0] = 0;
+        return line;
+    }
+    line[strcspn(line, "\n")] = 0;
+    return line;
+}
+
+int containsIgnoreCase(const char *text, const char *term)
+{
+    // term is already lowercase; compare in place instead of copying text
+    for (; *text; text++)
+    {
+        int i = 0;
+        while (term[i] && tolower((unsigned char)text[i]) == term[i])
+            i++;
+        if (term[i] == 0)
+            return 1;
+    }
+    return term[0] == 0;
+}
+
+char *arenaStrdup(const char *text)
+{
+    size_t length = strlen(text) + 1;
+
+    if (arena == NULL || arena->size - arena->used < length)
+    {
+        // Oversized strings get a block of their own
+        size_t size = length > ARENA_BLOCK_SIZE ? length : ARENA_BLOCK_SIZE;
+        ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+        if (block == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        block->next = arena;
+        block->used = 0;
+        block->size = size;
+        arena = block;
+    }
+
+    char *copy = arena->data + arena->used;
+    memcpy(copy, text, length);
+    arena->used += length;
+    arenaLiveBytes += length;
+    return copy;
+}
+
+void arenaRelease(const char *text)
+{
+    size_t length = strlen(text) + 1;
+    arenaLiveBytes -= length;
+    arenaDeadBytes += length;
+}
+
+void releaseEventStrings(const Event *event)
+{
+    arenaRelease(event->title);
+    arenaRelease(event->location);
+    arenaRelease(event->description);
+}
+
+void maybeCompactArena()
+{
+    // Only called once every live string is referenced from events[]
+    if (arenaDeadBytes > ARENA_BLOCK_SIZE && arenaDeadBytes > arenaLiveBytes)
+        compactArena();
+}
+
+void compactArena()
+{
+    // Every string moves, whichever change triggered the compaction
+    invalidateSummaries();
+
+    ArenaBlock *old = arena;
+    arena = NULL;
+    arenaLiveBytes = 0;
+    arenaDeadBytes = 0;
+
+    for (int i = 0; i < eventCount; i++)
+    {
+        events[i].title = arenaStrdup(events[i].title);
+        events[i].location = arenaStrdup(events[i].location);
+        events[i].description = arenaStrdup(events[i].description);
+    }
+
+    while (old != NULL)
+    {
+        ArenaBlock *next = old->next;
+        free(old);
+        old = next;
+    }
+}
+
+void indexEvent(const Event *event, int delta)
+{
+    setIdMonth(event->id, delta > 0 ? event->date : NULL);
+    trieUpdate(&titleTrie, event->title, delta);
+    trieUpdate(&locationTrie, event->location, delta);
+}
+
+void trieUpdate(TrieNode *root, const char *text, int delta)
+{
+    if (text[0] == 0)
+        return;
+
+    size_t length = strlen(text);
+    char *key = malloc(length + 1);
+    TrieNode **path = malloc((length + 1) * sizeof(TrieNode *)); // Each step eats a char
+    if (key == NULL || path == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+    for (size_t i = 0; i <= length; i++)
+    {
+        key[i] = tolower((unsigned char)text[i]);
+    }
+
+    int depth = 0;
+    TrieNode *node = root;
+    const char *rest = key;
+    path[depth++] = root;
+
+    while (*rest)
+    {
+        int index = trieFindChild(node, rest[0]);
+        if (index == -1)
+        {
+            if (delta < 0)
+                goto done; // Not indexed, nothing to remove
+
+            TrieNode *leaf = trieNewNode(rest, strlen(rest));
+            trieInsertChild(node, leaf);
+            node = leaf;
+            path[depth++] = node;
+            break;
+        }
+
+        TrieNode *child = node->children[index];
+        size_t common = 0;
+        while (child->label[common] && child->label[common] == rest[common])
+            common++;
+
+        if (child->label[common] != 0)
+        {
+            if (delta < 0)
+                goto done;
+
+            // The key leaves this edge part way along, so split it
+            TrieNode *middle = trieNewNode(child->label, common);
+            memmove(child->label, child->label + common, strlen(child->label + common) + 1);
+            trieInsertChild(middle, child);
+            node->children[index] = middle;
+            child = middle;
+        }
+
+        node = child;
+        path[depth++] = node;
+        rest += common;
+    }
+
+    if (delta > 0)
+    {
+        if (node->count == 0)
+            node->text = strdup(text);
+        node->count += delta;
+    }
+    else
+    {
+        if (node->count == 0)
+            goto done;
+
+        node->count += delta;
+        if (node->count <= 0)
+        {
+            node->count = 0;
+            free(node->text);
+            node->text = NULL;
+
+            // Drop the emptied leaf, then keep the path compressed
+            if (node->childCount == 0 && depth > 1)
+            {
+                TrieNode *parent = path[depth - 2];
+                trieRemoveChild(parent, node);
+                free(node->label);
+                free(node->children);
+                free(node);
+                node = parent;
+                depth--;
+            }
+            if (depth > 1 && node->count == 0 && node->childCount == 1)
+                trieMergeChild(node);
+        }
+    }
+
+    for (int i = depth - 1; i >= 0; i--)
+    {
+        trieRecomputeTop(path[i]);
+    }
+
+done:
+    free(path);
+    free(key);
+}
+
+int trieSuggest(TrieNode *root, const char *prefix, TrieNode **results)
+{
+    TrieNode *node = root;
+    const char *rest = prefix;
+
+    while (*rest)
+    {
+        int index = trieFindChild(node, tolower((unsigned char)rest[0]));
+        if (index == -1)
+            return 0;
+
+        TrieNode *child = node->children[index];
+        size_t common = 0;
+        while (child->label[common] && rest[common] &&
+               child->label[common] == tolower((unsigned char)rest[common]))
+            common++;
+
+        node = child;
+        if (rest[common] == 0)
+            break; // Prefix ends on or inside this edge
+        if (child->label[common] != 0)
+            return 0;
+        rest += common;
+    }
+
+    memcpy(results, node->top, node->topCount * sizeof(TrieNode *));
+    return node->topCount;
+}
+
+TrieNode *trieNewNode(const char *label, size_t length)
+{
+    TrieNode *node = calloc(1, sizeof(TrieNode));
+    if (node == NULL || (node->label = strndup(label, length)) == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+    return node;
+}
+
+int trieFindChild(const TrieNode *node, char first)
+{
+    int low = 0;
+    int high = node->childCount - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        unsigned char c = node->children[middle]->label[0];
+        if (c == (unsigned char)first)
+            return middle;
+        if (c < (unsigned char)first)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return -1;
+}
+
+void trieInsertChild(TrieNode *node, TrieNode *child)
+{
+    if (node->childCount == node->childCapacity)
+    {
+        node->childCapacity = node->childCapacity > 0 ? node->childCapacity * 2 : 2;
+        node->children = realloc(node->children, node->childCapacity * sizeof(TrieNode *));
+        if (node->children == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+    }
+
+    int i = node->childCount;
+    while (i > 0 && (unsigned char)node->children[i - 1]->label[0] > (unsigned char)child->label[0])
+    {
+        node->children[i] = node->children[i - 1];
+        i--;
+    }
+    node->children[i] = child;
+    node->childCount++;
+}
+
+void trieRemoveChild(TrieNode *node, const TrieNode *child)
+{
+    int index = trieFindChild(node, child->label[0]);
+    memmove(&node->children[index], &node->children[index + 1],
+            (node->childCount - index - 1) * sizeof(TrieNode *));
+    node->childCount--;
+}
+
+void trieMergeChild(TrieNode *node)
+{
+    // Fold a keyless node into its only child to keep edges compressed
+    TrieNode *only = node->children[0];
+    size_t length = strlen(node->label);
+    char *label = malloc(length + strlen(only->label) + 1);
+    if (label == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+    memcpy(label, node->label, length);
+    strcpy(label + length, only->label);
+
+    free(node->label);
+    free(node->children);
+    node->label = label;
+    node->children = only->children;
+    node->childCount = only->childCount;
+    node->childCapacity = only->childCapacity;
+    node->count = only->count;
+    node->text = only->text;
+
+    free(only->label);
+    free(only);
+}
+
+void trieRecomputeTop(TrieNode *node)
+{
+    // Children's lists cover disjoint keys, so merging them with this node's
+    // own key gives the best SUGGEST_TOP_K for the whole subtree
+    node->topCount = 0;
+    if (node->count > 0)
+        trieOfferTop(node, node);
+
+    for (int c = 0; c < node->childCount; c++)
+    {
+        TrieNode *child = node->children[c];
+        for (int i = 0; i < child->topCount; i++)
+        {
+            // Each list is sorted, so once one entry misses the rest will too
+            if (!trieOfferTop(node, child->top[i]))
+                break;
+        }
+    }
+}
+
+int trieOfferTop(TrieNode *node, TrieNode *candidate)
+{
+    int position = node->topCount;
+    while (position > 0 &&
+           (node->top[position - 1]->count < candidate->count ||
+            (node->top[position - 1]->count == candidate->count &&
+             strcmp(node->top[position - 1]->text, candidate->text) > 0)))
+        position--;
+
+    if (position >= SUGGEST_TOP_K)
+        return 0;
+
+    if (node->topCount < SUGGEST_TOP_K)
+        node->topCount++;
+    memmove(&node->top[position + 1], &node->top[position],
+            (node->topCount - position - 1) * sizeof(TrieNode *));
+    node->top[position] = candidate;
+    return 1;
+}
+
+void sortEvents()
+{
+    char keys[16];
+    printf("Sort by:\n");
+    printf("1. Date/Time\n");
+    printf("2. Title (Alphabetical)\n");
+    printf("3. Location\n");
+    printf("Enter one or more choices in priority order (e.g. 31 = location, then date/time): ");
+    fgets(keys, sizeof(keys), stdin);
+    keys[strcspn(keys, "\n")] = 0;
+
+    int keyCount = (int)strlen(keys);
+    if (keyCount == 0 || keyCount > 3)
+    {
+        printf("Invalid choice.\n");
+        return;
+    }
+    for (int k = 0; k < keyCount; k++)
+    {
+        if (keys[k] < '1' || keys[k] > '3' || strchr(keys + k + 1, keys[k]) != NULL)
+        {
+            printf("Invalid choice.\n");
+            return;
+        }
+    }
+
+    pthread_mutex_lock(&dataLock);
+    loadAllPartitions();
+    if (eventCount == 0)
+    {
+        pthread_mutex_unlock(&dataLock);
+        printf("No events to sort.\n");
+        return;
+    }
+
+    // Sort a permutation of indices; the records themselves never move
+    int *order = malloc(eventCount * sizeof(int));
+    int *scratch = malloc(eventCount * sizeof(int));
+    if (order == NULL || scratch == NULL)
+    {
+        pthread_mutex_unlock(&dataLock);
+        free(order);
+        free(scratch);
+        printf("Out of memory!\n");
+        return;
+    }
+    for (int i = 0; i < eventCount; i++)
+    {
+        order[i] = i;
+    }
+
+    // Both sorts are stable, so sorting by the least significant key first
+    // leaves ties on each key ordered by the keys after it
+    for (int k = keyCount - 1; k >= 0; k--)
+    {
+        if (keys[k] == '1')
+            radixSortByDateTime(order, scratch, eventCount);
+        else
+            mergeSortByText(order, scratch, eventCount, keys[k] - '0');
+    }
+
+    printf("\n=== Sorted Events ===\n");
+    printf("ID    Title                  Date         Time   Location   Description\n");
+    printf("-----------------------------------------------------------------------\n");
+    for (int i = 0; i < eventCount; i++)
+    {
+        const Event *event = &events[order[i]];
+        printf("%-5d %-22s %-12s %-6s %-10s %s\n",
+               event->id, event->title, event->date,
+               event->time, event->location, event->description);
+    }
+    pthread_mutex_unlock(&dataLock);
+
+    free(order);
+    free(scratch);
+}
+
+unsigned int dateTimeKey(const Event *event)
+{
+    // Pack year offset (7 bits), month (4), day (5), hour (5) and minute (6)
+    // into 27 bits so integer order matches chronological order
+    const char *d = event->date;
+    const char *t = event->time;
+    for (int i = 0; i < 10; i++)
+    {
+        if (i != 4 && i != 7 && !isdigit((unsigned char)d[i]))
+            return 0; // Malformed dates sort first
+    }
+
+    int year = (d[0] - '0') * 1000 + (d[1] - '0') * 100 + (d[2] - '0') * 10 + (d[3] - '0');
+    int month = (d[5] - '0') * 10 + (d[6] - '0');
+    int day = (d[8] - '0') * 10 + (d[9] - '0');
+    int hour = 0;
+    int minute = 0;
+    if (isdigit((unsigned char)t[0]) && isdigit((unsigned char)t[1]) &&
+        isdigit((unsigned char)t[3]) && isdigit((unsigned char)t[4]))
+    {
+        hour = (t[0] - '0') * 10 + (t[1] - '0');
+        minute = (t[3] - '0') * 10 + (t[4] - '0');
+    }
+
+    year -= SUMMARY_MIN_YEAR;
+    if (year < 0 || year > 127)
+        return 0;
+    return (unsigned int)year << 20 | (unsigned int)(month & 15) << 16 |
+           (unsigned int)(day & 31) << 11 | (unsigned int)(hour & 31) << 6 |
+           (unsigned int)(minute & 63);
+}
+
+void radixSortByDateTime(int *order, int *scratch, int count)
+{
+    unsigned int *keys = malloc(count * sizeof(unsigned int));
+    if (keys == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+
+    // Keys are indexed by event, so they are computed once for all passes
+    for (int i = 0; i < count; i++)
+    {
+        keys[i] = dateTimeKey(&events[i]);
+    }
+
+    // LSD radix sort: three stable counting passes of 9 bits each
+    for (int shift = 0; shift < 27; shift += 9)
+    {
+        int buckets[513] = {0};
+        for (int i = 0; i < count; i++)
+        {
+            buckets[((keys[order[i]] >> shift) & 511) + 1]++;
+        }
+        for (int b = 0; b < 512; b++)
+        {
+            buckets[b + 1] += buckets[b];
+        }
+        for (int i = 0; i < count; i++)
+        {
+            scratch[buckets[(keys[order[i]] >> shift) & 511]++] = order[i];
+        }
+        memcpy(order, scratch, count * sizeof(int));
+    }
+
+    free(keys);
+}
+
+void mergeSortByText(int *order, int *scratch, int count, int key)
+{
+    // Bottom-up merge sort; taking from the left run on ties keeps it stable
+    for (int width = 1; width < count; width *= 2)
+    {
+        for (int left = 0; left < count; left += 2 * width)
+        {
+            int middle = left + width < count ? left + width : count;
+            int right = left + 2 * width < count ? left + 2 * width : count;
+            int i = left;
+            int j = middle;
+            int k = left;
+
+            while (i < middle && j < right)
+            {
+                if (strcasecmp(sortText(order[j], key), sortText(order[i], key)) < 0)
+                    scratch[k++] = order[j++];
+                else
+                    scratch[k++] = order[i++];
+            }
+            while (i < middle)
+                scratch[k++] = order[i++];
+            while (j < right)
+                scratch[k++] = order[j++];
+        }
+        memcpy(order, scratch, count * sizeof(int));
+    }
+}
+
+const char *sortText(int index, int key)
+{
+    return key == 2 ? events[index].title : events[index].location;
+}
+
+void manageAttendees()
+{
+    if (isReplica)
+    {
+        printf("Attendee data is only available on the leader.\n");
+        return;
+    }
+    if (partitionCount == 0)
+    {
+        printf("No events to register for.\n");
+        return;
+    }
+
+    int choice;
+    printf("Attendees:\n");
+    printf("1. Register a user for an event\n");
+    printf("2. Cancel a registration\n");
+    printf("3. Attendee count for an event\n");
+    printf("4. Events a user attends\n");
+    printf("5. Users attending both of two events\n");
+    if (!promptNumber("Enter your choice: ", &choice))
+        return;
+
+    int eventId;
+    int otherId;
+    int userId;
+    int index;
+    int other;
+    int found = 0;
+
+    switch (choice)
+    {
+    case 1: // Register
+    case 2: // Cancel
+        if (!promptNumber("Enter event ID: ", &eventId) || !promptNumber("Enter user ID: ", &userId))
+            return;
+        if (userId < 0)
+        {
+            printf("User IDs can't be negative.\n");
+            return;
+        }
+
+        pthread_mutex_lock(&dataLock);
+        index = findEventIndex(eventId);
+        if (index == -1)
+        {
+            pthread_mutex_unlock(&dataLock);
+            printf("Event with ID %d not found.\n", eventId);
+            return;
+        }
+
+        Event *event = &events[index];
+        int attendeeCount = roaringCardinality(&event->attendees);
+        if (!loadPartition(getPartition(event->date)))
+            printf("Registration not changed: events for %.7s could not be read.\n", event->date);
+        else if (choice == 1 && event->capacity > 0 && attendeeCount >= event->capacity &&
+            !roaringContains(&event->attendees, userId))
+            printf("Event '%s' is full (%d/%d).\n", event->title, attendeeCount, event->capacity);
+        else if (choice == 1 && !roaringAdd(&event->attendees, userId))
+            printf("User %d is already registered for '%s'.\n", userId, event->title);
+        else if (choice == 2 && !roaringRemove(&event->attendees, userId))
+            printf("User %d is not registered for '%s'.\n", userId, event->title);
+        else
+        {
+            // Keep the user's side in step with the event's attendee set
+            if (choice == 1)
+                roaringAdd(eventsForUser(userId, 1), eventId);
+            else
+                roaringRemove(eventsForUser(userId, 1), eventId);
+            userEventsDirty = 1;
+            markPartitionDirty(event->date);
+            printf("User %d %s '%s'.\n", userId,
+                   choice == 1 ? "registered for" : "cancelled registration for", event->title);
+        }
+        pthread_mutex_unlock(&dataLock);
+        saveEvents();
+        break;
+
+    case 3: // Count
+        if (!promptNumber("Enter event ID: ", &eventId))
+            return;
+
+        pthread_mutex_lock(&dataLock);
+        index = findEventIndex(eventId);
+        if (index == -1)
+        {
+            pthread_mutex_unlock(&dataLock);
+            printf("Event with ID %d not found.\n", eventId);
+            return;
+        }
+
+        printf("Event '%s': %d attendees", events[index].title, roaringCardinality(&events[index].attendees));
+        if (events[index].capacity > 0)
+            printf(" (capacity %d)\n", events[index].capacity);
+        else
+            printf(" (unlimited capacity)\n");
+        pthread_mutex_unlock(&dataLock);
+        break;
+
+    case 4: // Events for a user
+        if (!promptNumber("Enter user ID: ", &userId))
+            return;
+
+        pthread_mutex_lock(&dataLock);
+        RoaringBitmap *attending = userId >= 0 ? eventsForUser(userId, 0) : NULL;
+        int attendingCount = attending != NULL ? roaringCardinality(attending) : 0;
+        unsigned int *eventIds = malloc((attendingCount > 0 ? attendingCount : 1) * sizeof(unsigned int));
+        if (eventIds == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        if (attending != NULL)
+            roaringToArray(attending, eventIds, attendingCount);
+
+        printf("\n=== Events user %d attends ===\n", userId);
+        printf("ID    Title                Date       Time   Location\n");
+        printf("----------------------------------------------------\n");
+        for (int i = 0; i < attendingCount; i++)
+        {
+            // Only the partitions holding these events get loaded
+            index = findEventIndex(eventIds[i]);
+            if (index == -1)
+                continue;
+            printf("%-5d %-20s %-10s %-6s %s\n",
+                   events[index].id, events[index].title, events[index].date,
+                   events[index].time, events[index].location);
+            found = 1;
+        }
+        pthread_mutex_unlock(&dataLock);
+        free(eventIds);
+
+        if (!found)
+            printf("User %d is not registered for any events.\n", userId);
+        break;
+
+    case 5: // Intersection
+        if (!promptNumber("Enter first event ID: ", &eventId) ||
+            !promptNumber("Enter second event ID: ", &otherId))
+            return;
+
+        pthread_mutex_lock(&dataLock);
+        index = findEventIndex(eventId);
+        other = findEventIndex(otherId);
+        if (index == -1 || other == -1)
+        {
+            pthread_mutex_unlock(&dataLock);
+            printf("Event with ID %d not found.\n", index == -1 ? eventId : otherId);
+            return;
+        }
+
+        RoaringBitmap both = {0};
+        unsigned int users[ATTENDEE_LIST_MAX];
+        roaringAnd(&events[index].attendees, &events[other].attendees, &both);
+        int shown = roaringToArray(&both, users, ATTENDEE_LIST_MAX);
+        int total = roaringCardinality(&both);
+
+        printf("%d users attend both '%s' and '%s'", total, events[index].title, events[other].title);
+        printf(total > 0 ? ":\n " : ".\n");
+        for (int i = 0; i < shown; i++)
+        {
+            printf(" %u", users[i]);
+        }
+        if (total > shown)
+            printf(" ... and %d more", total - shown);
+        if (total > 0)
+            printf("\n");
+        pthread_mutex_unlock(&dataLock);
+        roaringFree(&both);
+        break;
+
+    default:
+        printf("Invalid choice.\n");
+    }
+}
+
+int promptNumber(const char *prompt, int *value)
+{
+    printf("%s", prompt);
+    if (scanf("%d", value) != 1)
+    {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return 0;
+    }
+    clearInputBuffer(); // Consume newline
+    return 1;
+}
+
+void saveAttendees(const char *key)
 {
-    if (strlen(time) != 5)
-        return 0;
-    if (time[2] != ':')
-        return 0;
+    // Binary file of (event id, bitmap) pairs for events with attendees
+    char filename[64];
+    snprintf(filename, sizeof(filename), ATTENDEE_FILE_FORMAT, key);
 
-    int hour, minute;
-    if (sscanf(time, "%d:%d", &hour, &minute) != 2)
-        return 0;
+    FILE *file = NULL;
+    for (int i = 0; i < eventCount; i++)
+    {
+        if (events[i].attendees.count == 0 ||
+            strncmp(events[i].date, key, PARTITION_KEY_LEN - 1) != 0)
+            continue;
 
-    if (hour < 0 || hour > 23)
-        return 0;
-    if (minute < 0 || minute > 59)
-        return 0;
+        if (file == NULL && (file = fopen(filename, "wb")) == NULL)
+        {
+            printf("Error opening file for writing.\n");
+            return;
+        }
+        fwrite(&events[i].id, sizeof(int), 1, file);
+        roaringWrite(&events[i].attendees, file);
+    }
 
-    return 1;
+    if (file != NULL)
+        fclose(file);
+    else
+        remove(filename); // Nobody registered in this month any more
 }
 
-void toLowerCase(char *str)
+void loadAttendees(const char *key)
 {
-    for (int i = 0; str[i]; i++)
+    char filename[64];
+    snprintf(filename, sizeof(filename), ATTENDEE_FILE_FORMAT, key);
+
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+        return;
+
+    int id;
+    while (fread(&id, sizeof(int), 1, file) == 1)
     {
-        str[i] = tolower(str[i]);
+        RoaringBitmap attendees = {0};
+        if (!roaringRead(&attendees, file))
+        {
+            printf("Error reading %s.\n", filename);
+            roaringFree(&attendees);
+            break;
+        }
+
+        int index = lookupEventIndex(id);
+        if (index != -1)
+        {
+            roaringFree(&events[index].attendees);
+            events[index].attendees = attendees;
+        }
+        else
+        {
+            roaringFree(&attendees);
+        }
     }
+
+    fclose(file);
 }
 
-/*
+RoaringBitmap *eventsForUser(int userId, int create)
+{
+    // Returns NULL for a user without an entry unless create is set
+    if (userEventCapacity == 0 && !create)
+        return NULL;
+
+    if (create && (userEventCount + 1) * 2 > userEventCapacity)
+    {
+        // Rehash into a table twice the size, moving the bitmaps over
+        UserEvents *old = userEvents;
+        int oldCapacity = userEventCapacity;
+        userEventCapacity = oldCapacity > 0 ? oldCapacity * 2 : 64;
+        userEvents = malloc(userEventCapacity * sizeof(UserEvents));
+        if (userEvents == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+        for (int i = 0; i < userEventCapacity; i++)
+        {
+            userEvents[i].userId = -1;
+        }
+
+        unsigned int mask = userEventCapacity - 1;
+        for (int i = 0; i < oldCapacity; i++)
+        {
+            if (old[i].userId == -1)
+                continue;
+            unsigned int slot = (unsigned int)old[i].userId * 2654435761u & mask;
+            while (userEvents[slot].userId != -1)
+                slot = (slot + 1) & mask;
+            userEvents[slot] = old[i];
+        }
+        free(old);
+    }
+
+    unsigned int mask = userEventCapacity - 1;
+    unsigned int slot = (unsigned int)userId * 2654435761u & mask;
+    while (userEvents[slot].userId != -1)
+    {
+        if (userEvents[slot].userId == userId)
+            return &userEvents[slot].events;
+        slot = (slot + 1) & mask;
+    }
+
+    if (!create)
+        return NULL;
+
+    userEvents[slot].userId = userId;
+    memset(&userEvents[slot].events, 0, sizeof(RoaringBitmap));
+    userEventCount++;
+    return &userEvents[slot].events;
+}
 
-int compareDates(const char *date1, const char *date2)
+void forgetAttendees(const Event *event)
 {
-    int y1, m1, d1, y2, m2, d2;
-    sscanf(date1, "%d-%d-%d", &y1, &m1, &d1);
-    sscanf(date2, "%d-%d-%d", &y2, &m2, &d2);
+    // A deleted event leaves the bitmap of everyone registered for it
+    int count = roaringCardinality(&event->attendees);
+    if (count == 0)
+        return;
 
-    if (y1 != y2)
-        return y1 - y2;
-    if (m1 != m2)
-        return m1 - m2;
-    return d1 - d2;
+    unsigned int *users = malloc(count * sizeof(unsigned int));
+    if (users == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+    roaringToArray(&event->attendees, users, count);
+    for (int i = 0; i < count; i++)
+    {
+        RoaringBitmap *attending = eventsForUser(users[i], 0);
+        if (attending != NULL)
+            roaringRemove(attending, event->id);
+    }
+    free(users);
+    userEventsDirty = 1;
 }
 
-void sortEvents()
+void saveUserEvents()
 {
-    if (eventCount == 0)
+    // Same layout as the partition .rsvp files, keyed by user id instead
+    if (userEventsPartial)
+        return;
+
+    FILE *file = fopen(USER_EVENTS_FILENAME, "wb");
+    if (file == NULL)
     {
-        printf("No events to sort.\n");
+        printf("Error opening file for writing.\n");
         return;
     }
 
-    int choice;
-    printf("Sort by:\n");
-    printf("1. Date/Time\n");
-    printf("2. Title (Alphabetical)\n");
-    printf("3. Location\n");
-    printf("Enter your choice: ");
-    if (scanf("%d", &choice) != 1)
+    for (int i = 0; i < userEventCapacity; i++)
     {
-        printf("Invalid input! Please enter a number.\n");
-        clearInputBuffer();
+        if (userEvents[i].userId == -1 || userEvents[i].events.count == 0)
+            continue;
+        fwrite(&userEvents[i].userId, sizeof(int), 1, file);
+        roaringWrite(&userEvents[i].events, file);
+    }
+
+    fclose(file);
+    userEventsDirty = 0;
+}
+
+void loadUserEvents()
+{
+    FILE *file = fopen(USER_EVENTS_FILENAME, "rb");
+    if (file == NULL)
+    {
+        // Registrations saved before the per-user index existed are only in
+        // the partition files, so rebuild it from them once
+        for (int p = 0; p < partitionCount && file == NULL; p++)
+        {
+            char filename[64];
+            snprintf(filename, sizeof(filename), ATTENDEE_FILE_FORMAT, partitions[p].key);
+            file = fopen(filename, "rb");
+        }
+        if (file == NULL)
+            return;
+        fclose(file);
+
+        userEventsPartial = !loadAllPartitions();
+        for (int i = 0; i < eventCount; i++)
+        {
+            int count = roaringCardinality(&events[i].attendees);
+            unsigned int *users = malloc((count > 0 ? count : 1) * sizeof(unsigned int));
+            if (users == NULL)
+            {
+                printf("Out of memory!\n");
+                exit(1);
+            }
+            roaringToArray(&events[i].attendees, users, count);
+            for (int u = 0; u < count; u++)
+            {
+                roaringAdd(eventsForUser(users[u], 1), events[i].id);
+            }
+            free(users);
+        }
+        if (userEventsPartial)
+        {
+            printf("Attendee index incomplete; it will be rebuilt on the next start.\n");
+            return;
+        }
+        saveUserEvents();
+        printf("Built attendee index for %d users.\n", userEventCount);
         return;
     }
-    clearInputBuffer(); // Consume newline
 
-    // Bubble sort implementation
-    for (int i = 0; i < eventCount - 1; i++)
+    int userId;
+    while (fread(&userId, sizeof(int), 1, file) == 1)
+    {
+        RoaringBitmap *attending = userId >= 0 ? eventsForUser(userId, 1) : NULL;
+        if (attending == NULL || !roaringRead(attending, file))
+        {
+            printf("Error reading %s.\n", USER_EVENTS_FILENAME);
+            break;
+        }
+    }
+
+    fclose(file);
+}
+
+int roaringFind(const RoaringBitmap *bitmap, unsigned short key)
+{
+    // Returns the container index, or -(insertion point) - 1 if absent
+    int low = 0;
+    int high = bitmap->count - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        if (bitmap->containers[middle].key == key)
+            return middle;
+        if (bitmap->containers[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return -low - 1;
+}
+
+int roaringArrayPosition(const RoaringContainer *container, unsigned short value)
+{
+    // First position in the sorted array holding a value >= value
+    int low = 0;
+    int high = container->cardinality;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (container->array[middle] < value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+int roaringAdd(RoaringBitmap *bitmap, unsigned int value)
+{
+    unsigned short key = value >> 16;
+    unsigned short low = value & 0xFFFF;
+    int index = roaringFind(bitmap, key);
+
+    if (index < 0)
+    {
+        RoaringContainer container = {0};
+        container.key = key;
+        index = -index - 1;
+        roaringAppend(bitmap, &container);
+        memmove(&bitmap->containers[index + 1], &bitmap->containers[index],
+                (bitmap->count - index - 1) * sizeof(RoaringContainer));
+        bitmap->containers[index] = container;
+    }
+
+    RoaringContainer *container = &bitmap->containers[index];
+    if (container->bits == NULL && container->cardinality == ROARING_ARRAY_MAX)
+    {
+        int position = roaringArrayPosition(container, low);
+        if (position < container->cardinality && container->array[position] == low)
+            return 0;
+        roaringToBits(container);
+    }
+
+    if (container->bits != NULL)
+    {
+        unsigned long long mask = 1ULL << (low & 63);
+        if (container->bits[low >> 6] & mask)
+            return 0;
+        container->bits[low >> 6] |= mask;
+        container->cardinality++;
+        return 1;
+    }
+
+    int position = roaringArrayPosition(container, low);
+    if (position < container->cardinality && container->array[position] == low)
+        return 0;
+
+    if (container->cardinality == container->arrayCapacity)
+    {
+        container->arrayCapacity = container->arrayCapacity > 0 ? container->arrayCapacity * 2 : 4;
+        if (container->arrayCapacity > ROARING_ARRAY_MAX)
+            container->arrayCapacity = ROARING_ARRAY_MAX;
+        container->array = realloc(container->array, container->arrayCapacity * sizeof(unsigned short));
+        if (container->array == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+    }
+
+    memmove(&container->array[position + 1], &container->array[position],
+            (container->cardinality - position) * sizeof(unsigned short));
+    container->array[position] = low;
+    container->cardinality++;
+    return 1;
+}
+
+int roaringRemove(RoaringBitmap *bitmap, unsigned int value)
+{
+    unsigned short low = value & 0xFFFF;
+    int index = roaringFind(bitmap, value >> 16);
+    if (index < 0)
+        return 0;
+
+    RoaringContainer *container = &bitmap->containers[index];
+    if (container->bits != NULL)
+    {
+        unsigned long long mask = 1ULL << (low & 63);
+        if (!(container->bits[low >> 6] & mask))
+            return 0;
+        container->bits[low >> 6] &= ~mask;
+        container->cardinality--;
+        if (container->cardinality <= ROARING_ARRAY_MAX)
+            roaringToArrayContainer(container);
+    }
+    else
+    {
+        int position = roaringArrayPosition(container, low);
+        if (position == container->cardinality || container->array[position] != low)
+            return 0;
+        memmove(&container->array[position], &container->array[position + 1],
+                (container->cardinality - position - 1) * sizeof(unsigned short));
+        container->cardinality--;
+    }
+
+    if (container->cardinality == 0)
+    {
+        free(container->array);
+        free(container->bits);
+        memmove(&bitmap->containers[index], &bitmap->containers[index + 1],
+                (bitmap->count - index - 1) * sizeof(RoaringContainer));
+        bitmap->count--;
+    }
+    return 1;
+}
+
+int roaringContains(const RoaringBitmap *bitmap, unsigned int value)
+{
+    unsigned short low = value & 0xFFFF;
+    int index = roaringFind(bitmap, value >> 16);
+    if (index < 0)
+        return 0;
+
+    const RoaringContainer *container = &bitmap->containers[index];
+    if (container->bits != NULL)
+        return (container->bits[low >> 6] >> (low & 63)) & 1;
+
+    int position = roaringArrayPosition(container, low);
+    return position < container->cardinality && container->array[position] == low;
+}
+
+int roaringCardinality(const RoaringBitmap *bitmap)
+{
+    int total = 0;
+    for (int i = 0; i < bitmap->count; i++)
+    {
+        total += bitmap->containers[i].cardinality;
+    }
+    return total;
+}
+
+void roaringAnd(const RoaringBitmap *a, const RoaringBitmap *b, RoaringBitmap *result)
+{
+    // Only containers with matching high bits can share values
+    int i = 0;
+    int j = 0;
+    while (i < a->count && j < b->count)
     {
-        for (int j = 0; j < eventCount - i - 1; j++)
+        const RoaringContainer *x = &a->containers[i];
+        const RoaringContainer *y = &b->containers[j];
+        if (x->key < y->key)
+        {
+            i++;
+            continue;
+        }
+        if (x->key > y->key)
         {
-            int swap = 0;
+            j++;
+            continue;
+        }
 
-            switch (choice)
+        RoaringContainer both = {0};
+        both.key = x->key;
+
+        if (x->bits != NULL && y->bits != NULL)
+        {
+            // Word-wise AND, then fall back to an array if the result is sparse
+            both.bits = malloc(1024 * sizeof(unsigned long long));
+            if (both.bits == NULL)
             {
-            case 1: // Sort by date/time
-                if (compareDates(events[j].date, events[j + 1].date) > 0)
-                {
-                    swap = 1;
-                }
-                else if (compareDates(events[j].date, events[j + 1].date) == 0)
-                {
-                    // If dates are equal, compare times
-                    if (strcmp(events[j].time, events[j + 1].time) > 0)
-                    {
-                        swap = 1;
-                    }
-                }
-                break;
+                printf("Out of memory!\n");
+                exit(1);
+            }
+            for (int w = 0; w < 1024; w++)
+            {
+                both.bits[w] = x->bits[w] & y->bits[w];
+                both.cardinality += __builtin_popcountll(both.bits[w]);
+            }
+            if (both.cardinality <= ROARING_ARRAY_MAX)
+                roaringToArrayContainer(&both);
+        }
+        else
+        {
+            // At least one side is an array, so the result fits in an array
+            const RoaringContainer *small = x->bits == NULL ? x : y;
+            const RoaringContainer *large = small == x ? y : x;
+            both.array = malloc((small->cardinality > 0 ? small->cardinality : 1) * sizeof(unsigned short));
+            if (both.array == NULL)
+            {
+                printf("Out of memory!\n");
+                exit(1);
+            }
+            both.arrayCapacity = small->cardinality;
 
-            case 2: // Sort by title
-                if (strcasecmp(events[j].title, events[j + 1].title) > 0)
+            int k = 0;
+            for (int v = 0; v < small->cardinality; v++)
+            {
+                unsigned short low = small->array[v];
+                if (large->bits != NULL)
                 {
-                    swap = 1;
+                    if ((large->bits[low >> 6] >> (low & 63)) & 1)
+                        both.array[both.cardinality++] = low;
                 }
-                break;
-
-            case 3: // Sort by location
-                if (strcasecmp(events[j].location, events[j + 1].location) > 0)
+                else
                 {
-                    swap = 1;
+                    // Both sorted: advance through the larger array in step
+                    while (k < large->cardinality && large->array[k] < low)
+                        k++;
+                    if (k < large->cardinality && large->array[k] == low)
+                        both.array[both.cardinality++] = low;
                 }
-                break;
+            }
+        }
 
-            default:
-                printf("Invalid choice.\n");
-                return;
+        if (both.cardinality > 0)
+        {
+            roaringAppend(result, &both);
+        }
+        else
+        {
+            free(both.array);
+            free(both.bits);
+        }
+        i++;
+        j++;
+    }
+}
+
+int roaringToArray(const RoaringBitmap *bitmap, unsigned int *values, int max)
+{
+    int count = 0;
+    for (int i = 0; i < bitmap->count && count < max; i++)
+    {
+        const RoaringContainer *container = &bitmap->containers[i];
+        unsigned int high = (unsigned int)container->key << 16;
+        if (container->bits == NULL)
+        {
+            for (int v = 0; v < container->cardinality && count < max; v++)
+            {
+                values[count++] = high | container->array[v];
             }
+            continue;
+        }
 
-            if (swap)
+        for (int w = 0; w < 1024 && count < max; w++)
+        {
+            unsigned long long word = container->bits[w];
+            while (word != 0 && count < max)
             {
-                Event temp = events[j];
-                events[j] = events[j + 1];
-                events[j + 1] = temp;
+                values[count++] = high | (w * 64 + __builtin_ctzll(word));
+                word &= word - 1;
             }
         }
     }
+    return count;
+}
 
-    saveEvents();
-    printf("Events sorted successfully.\n");
-    viewEvents();
+void roaringToBits(RoaringContainer *container)
+{
+    container->bits = calloc(1024, sizeof(unsigned long long));
+    if (container->bits == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+    for (int v = 0; v < container->cardinality; v++)
+    {
+        unsigned short low = container->array[v];
+        container->bits[low >> 6] |= 1ULL << (low & 63);
+    }
+    free(container->array);
+    container->array = NULL;
+    container->arrayCapacity = 0;
+}
+
+void roaringToArrayContainer(RoaringContainer *container)
+{
+    container->arrayCapacity = container->cardinality > 0 ? container->cardinality : 1;
+    container->array = malloc(container->arrayCapacity * sizeof(unsigned short));
+    if (container->array == NULL)
+    {
+        printf("Out of memory!\n");
+        exit(1);
+    }
+
+    int count = 0;
+    for (int w = 0; w < 1024; w++)
+    {
+        unsigned long long word = container->bits[w];
+        while (word != 0)
+        {
+            container->array[count++] = w * 64 + __builtin_ctzll(word);
+            word &= word - 1;
+        }
+    }
+    free(container->bits);
+    container->bits = NULL;
+}
+
+void roaringAppend(RoaringBitmap *bitmap, const RoaringContainer *container)
+{
+    if (bitmap->count == bitmap->capacity)
+    {
+        bitmap->capacity = bitmap->capacity > 0 ? bitmap->capacity * 2 : 1;
+        bitmap->containers = realloc(bitmap->containers, bitmap->capacity * sizeof(RoaringContainer));
+        if (bitmap->containers == NULL)
+        {
+            printf("Out of memory!\n");
+            exit(1);
+        }
+    }
+    bitmap->containers[bitmap->count++] = *container;
+}
+
+void roaringFree(RoaringBitmap *bitmap)
+{
+    for (int i = 0; i < bitmap->count; i++)
+    {
+        free(bitmap->containers[i].array);
+        free(bitmap->containers[i].bits);
+    }
+    free(bitmap->containers);
+    memset(bitmap, 0, sizeof(RoaringBitmap));
 }
 
-*/
\ No newline at end of file
+int roaringWrite(const RoaringBitmap *bitmap, FILE *file)
+{
+    // Layout: container count, then per container its key, cardinality and
+    // either the sorted low bits or the 1024-word bitmap
+    fwrite(&bitmap->count, sizeof(int), 1, file);
+    for (int i = 0; i < bitmap->count; i++)
+    {
+        const RoaringContainer *container = &bitmap->containers[i];
+        fwrite(&container->key, sizeof(unsigned short), 1, file);
+        fwrite(&container->cardinality, sizeof(int), 1, file);
+        if (container->bits != NULL)
+            fwrite(container->bits, sizeof(unsigned long long), 1024, file);
+        else
+            fwrite(container->array, sizeof(unsigned short), container->cardinality, file);
+    }
+    return !ferror(file);
+}
+
+int roaringRead(RoaringBitmap *bitmap, FILE *file)
+{
+    int count;
+    if (fread(&count, sizeof(int), 1, file) != 1 || count < 0 || count > 65536)
+        return 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        RoaringContainer container = {0};
+        if (fread(&container.key, sizeof(unsigned short), 1, file) != 1 ||
+            fread(&container.cardinality, sizeof(int), 1, file) != 1 ||
+            container.cardinality < 1 || container.cardinality > 65536)
+            return 0;
+
+        // Append first so roaringFree() cleans up a partially read container
+        int dense = container.cardinality > ROARING_ARRAY_MAX;
+        if (dense)
+            container.bits = malloc(1024 * sizeof(unsigned long long));
+        else
+            container.array = malloc(container.cardinality * sizeof(unsigned short));
+        if (container.bits == NULL && container.array == NULL)
+            return 0;
+        container.arrayCapacity = dense ? 0 : container.cardinality;
+        roaringAppend(bitmap, &container);
+
+        size_t read = dense ? fread(container.bits, sizeof(unsigned long long), 1024, file)
+                            : fread(container.array, sizeof(unsigned short), container.cardinality, file);
+        if (read != (dense ? 1024u : (size_t)container.cardinality))
+            return 0;
+    }
+    return 1;
+}